@@ -0,0 +1,91 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_arena.h"
+#include <algorithm>
+
+namespace expr {
+
+const size_t arena::MIN_CHUNK_SIZE;
+const size_t arena::MAX_CHUNK_SIZE;
+
+static thread_local arena* s_current = nullptr;
+
+arena::~arena() {
+    for (auto iter = m_finalizers.rbegin(); m_finalizers.rend() != iter; ++iter) {
+        iter->destroy(iter->object);
+    }
+
+    for (char* chunk : m_chunks) {
+        ::operator delete(chunk);
+    }
+}
+
+void* arena::allocate(size_t size, size_t align) {
+    size_t padding = (align - reinterpret_cast<size_t>(m_cursor) % align) % align;
+    if (m_left < size + padding) {
+        size_t chunk_size = std::max(m_next_size, size + align);
+        char* chunk = static_cast<char*>(::operator new(chunk_size));
+        m_chunks.push_back(chunk);
+        m_reserved += chunk_size;
+        if (MAX_CHUNK_SIZE / 4 < size) {
+            char* object = chunk + (align - reinterpret_cast<size_t>(chunk) % align) % align;
+            m_allocated += size;
+            return object;
+        }
+
+        m_cursor = chunk;
+        m_left = chunk_size;
+        m_next_size = std::min(m_next_size * 2, MAX_CHUNK_SIZE);
+        padding = (align - reinterpret_cast<size_t>(m_cursor) % align) % align;
+    }
+
+    char* object = m_cursor + padding;
+    m_cursor = object + size;
+    m_left -= size + padding;
+    m_allocated += size;
+    return object;
+}
+
+size_t arena::allocated() const {
+    return m_allocated;
+}
+
+size_t arena::reserved() const {
+    return m_reserved;
+}
+
+arena* arena::current() {
+    return s_current;
+}
+
+arena::scope::scope(arena* current) : m_previous(s_current) {
+    s_current = current;
+}
+
+arena::scope::~scope() {
+    s_current = m_previous;
+}
+
+}
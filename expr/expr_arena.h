@@ -0,0 +1,110 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EXPR_ARENA_H
+#define EXPR_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "expr_pool.h"
+
+namespace expr {
+
+// bump allocator, not thread-safe
+class arena {
+public:
+    arena() = default;
+    arena(const arena& other) = delete;
+    ~arena();
+
+    arena& operator=(const arena& other) = delete;
+
+public:
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    template<class value_t, class... args_t>
+    value_t* create(args_t&&... args) {
+        value_t* object = new (allocate(sizeof(value_t), alignof(value_t))) value_t(std::forward<args_t>(args)...);
+        if (!std::is_trivially_destructible<value_t>::value) {
+            m_finalizers.push_back({&destroy<value_t>, object});
+        }
+        return object;
+    }
+
+    size_t allocated() const;
+    size_t reserved() const;
+
+    static arena* current();
+
+    class scope {
+    public:
+        explicit scope(arena* current);
+        scope(const scope& other) = delete;
+        ~scope();
+
+        scope& operator=(const scope& other) = delete;
+
+    private:
+        arena* m_previous;
+    };
+
+private:
+    template<class value_t>
+    static void destroy(void* object) {
+        static_cast<value_t*>(object)->~value_t();
+    }
+
+    struct finalizer {
+        void (*destroy)(void* object);
+        void* object;
+    };
+
+private:
+    static const size_t MIN_CHUNK_SIZE = 1024;
+    static const size_t MAX_CHUNK_SIZE = 1024 * 1024;
+
+    std::vector<char*> m_chunks;
+    std::vector<finalizer> m_finalizers;
+    char* m_cursor = nullptr;
+    size_t m_left = 0;
+    size_t m_next_size = MIN_CHUNK_SIZE;
+    size_t m_allocated = 0;
+    size_t m_reserved = 0;
+};
+
+using arena_ptr = std::shared_ptr<arena>;
+
+template<class value_t, class... args_t>
+value_t* create_object(args_t&&... args) {
+    arena* current = arena::current();
+    return current ? current->create<value_t>(std::forward<args_t>(args)...) : make_payload<value_t>(std::forward<args_t>(args)...);
+}
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_batch.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace expr {
+
+const size_t PARSE_CHUNK_SIZE = 64;
+
+class worker_pool {
+public:
+    ~worker_pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopped = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    void run(size_t helpers, const std::function<void()>& work) {
+        size_t pending = helpers;
+        std::condition_variable done;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (m_workers.size() < helpers) {
+                m_workers.emplace_back(&worker_pool::serve, this);
+            }
+            for (size_t index = 0; index < helpers; ++index) {
+                m_tasks.push_back([this, &work, &pending, &done]() {
+                    work();
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!--pending) {
+                        done.notify_one();
+                    }
+                });
+            }
+        }
+        m_wake.notify_all();
+
+        work();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        done.wait(lock, [&pending]() { return !pending; });
+    }
+
+    static worker_pool& instance() {
+        static worker_pool pool;
+        return pool;
+    }
+
+private:
+    void serve() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this]() { return m_stopped || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+
+            std::function<void()> task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::function<void()>> m_tasks;
+    std::vector<std::thread> m_workers;
+    bool m_stopped = false;
+};
+
+template<class source_t>
+std::vector<handler> parse_sources(const source_t* sources, size_t count, size_t threads, const library_ptr& lib) {
+    std::vector<handler> handlers(count);
+    if (!threads) {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    threads = std::min(threads, (count + PARSE_CHUNK_SIZE - 1) / PARSE_CHUNK_SIZE);
+
+    std::atomic<size_t> next(0);
+    auto work = [sources, count, &lib, &handlers, &next]() {
+        while (true) {
+            size_t begin = next.fetch_add(PARSE_CHUNK_SIZE);
+            if (count <= begin) {
+                break;
+            }
+
+            size_t end = std::min(begin + PARSE_CHUNK_SIZE, count);
+            for (size_t index = begin; index < end; ++index) {
+                handlers[index] = handler(sources[index], lib);
+            }
+        }
+    };
+
+    if (1 < threads) {
+        worker_pool::instance().run(threads - 1, work);
+    } else {
+        work();
+    }
+
+    return handlers;
+}
+
+std::vector<handler> parse_all(const string_t* sources, size_t count, size_t threads, library_ptr lib) {
+    return parse_sources(sources, count, threads, lib);
+}
+
+std::vector<handler> parse_all(const std::string* sources, size_t count, size_t threads, library_ptr lib) {
+    return parse_sources(sources, count, threads, lib);
+}
+
+}
@@ -0,0 +1,513 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_blob.h"
+#include <cstring>
+#include <fstream>
+#include "expr_link.h"
+
+#if defined(K_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(K_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace expr {
+
+const char BLOB_MAGIC[4] = {'E', 'X', 'P', 'R'};
+const char BUNDLE_MAGIC[4] = {'E', 'X', 'P', 'S'};
+const uint16_t BLOB_VERSION = 1;
+const uint16_t BYTE_ORDER_MARK = 0x0102;
+
+enum blob_flag : uint8_t {
+    FLAG_EXPR       = 1 << 0,
+    FLAG_DEFINES    = 1 << 1,
+    FLAG_LEFT       = 1 << 2,
+    FLAG_RIGHT      = 1 << 3,
+    FLAG_FUNCTION   = 1 << 4
+};
+
+template<class value_t>
+void write_value(std::string& blob, value_t value) {
+    blob.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void write_string(std::string& blob, const string_t& str) {
+    std::string utf8 = to_utf8(str);
+    write_value<uint32_t>(blob, static_cast<uint32_t>(utf8.size()));
+    blob += utf8;
+}
+
+void write_header(std::string& blob, const char (&magic)[4]) {
+    blob.append(magic, sizeof(magic));
+    write_value(blob, BLOB_VERSION);
+    write_value(blob, BYTE_ORDER_MARK);
+}
+
+class blob_reader {
+public:
+    blob_reader(const char* data, size_t size) : m_data(data), m_size(size) {}
+
+    template<class value_t>
+    value_t read() {
+        value_t value = value_t();
+        if (m_failed || m_size - m_pos < sizeof(value)) {
+            m_failed = true;
+            return value;
+        }
+
+        memcpy(&value, m_data + m_pos, sizeof(value));
+        m_pos += sizeof(value);
+        return value;
+    }
+
+    string_t read_string() {
+        uint32_t size = read<uint32_t>();
+        if (m_failed || m_size - m_pos < size) {
+            m_failed = true;
+            return string_t();
+        }
+
+        const char* str = m_data + m_pos;
+        m_pos += size;
+        string_t res;
+        res.reserve(size);
+        for (size_t pos = 0; pos < size;) {
+            size_t begin = pos;
+            char_t ch = decode_utf8(str, size, pos);
+            if (0xFFFD == ch && (3 != pos - begin || memcmp(str + begin, "\xEF\xBF\xBD", 3))) {
+                m_failed = true;
+                return string_t();
+            }
+            res += ch;
+        }
+        return res;
+    }
+
+    bool read_header(const char (&magic)[4]) {
+        if (m_size < sizeof(magic) || memcmp(m_data, magic, sizeof(magic))) {
+            m_failed = true;
+            return false;
+        }
+
+        m_pos = sizeof(magic);
+        return BLOB_VERSION == read<uint16_t>() && BYTE_ORDER_MARK == read<uint16_t>() && !m_failed;
+    }
+
+    void fail() {
+        m_failed = true;
+    }
+
+    size_t remaining() const {
+        return m_size - m_pos;
+    }
+
+    bool failed() const {
+        return m_failed;
+    }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_pos = 0;
+    bool m_failed = false;
+};
+
+void save_node(const node* nd, std::string& blob) {
+    write_header(blob, BLOB_MAGIC);
+
+    std::vector<const node*> pending;
+    if (nd) {
+        pending.push_back(nd);
+    }
+
+    while (!pending.empty()) {
+        nd = pending.back();
+        pending.pop_back();
+
+        uint8_t flags = (nd->defines ? FLAG_DEFINES : 0);
+        if (nd->is_expr()) {
+            flags |= FLAG_EXPR | (nd->expr.left ? FLAG_LEFT : 0) | (nd->expr.right ? FLAG_RIGHT : 0);
+            flags |= nd->is_function() ? FLAG_FUNCTION : 0;
+        }
+        write_value(blob, flags);
+
+        if (nd->is_expr()) {
+            if (nd->is_function()) {
+                write_string(blob, symbol_name(nd->expr.oper.function->name));
+            } else {
+                write_value<uint16_t>(blob, nd->expr.oper.code);
+            }
+
+            if (nd->expr.right) {
+                pending.push_back(nd->expr.right);
+            }
+            if (nd->expr.left) {
+                pending.push_back(nd->expr.left);
+            }
+        } else {
+            write_value<uint8_t>(blob, nd->obj.type);
+            switch (nd->obj.type) {
+            case object::BOOLEAN:
+                write_value<uint8_t>(blob, nd->obj.boolean);
+                break;
+            case object::REAL:
+                write_value(blob, nd->obj.real);
+                break;
+            case object::IMAGINARY:
+                write_value(blob, nd->obj.imaginary);
+                break;
+            case object::STRING:
+                write_string(blob, *nd->obj.string);
+                break;
+            case object::PARAM:
+                write_string(blob, symbol_name(nd->obj.param));
+                break;
+            case object::VARIABLE:
+                write_value<uint32_t>(blob, nd->obj.variable);
+                break;
+            case object::ARRAY:
+                write_value<uint32_t>(blob, static_cast<uint32_t>(nd->obj.array->size()));
+                pending.insert(pending.end(), nd->obj.array->rbegin(), nd->obj.array->rend());
+                break;
+            case object::REAL_ARRAY:
+                write_value<uint32_t>(blob, static_cast<uint32_t>(nd->obj.reals->size()));
+                blob.append(reinterpret_cast<const char*>(nd->obj.reals->data()), nd->obj.reals->size() * sizeof(real_t));
+                break;
+            }
+        }
+
+        if (nd->defines) {
+            pending.push_back(nd->defines);
+        }
+    }
+}
+
+node* load_node(const char* data, size_t size) {
+    blob_reader reader(data, size);
+    if (!reader.read_header(BLOB_MAGIC)) {
+        return nullptr;
+    }
+
+    enum slot_place {
+        ROOT,
+        DEFINES,
+        LEFT,
+        RIGHT,
+        ITEM
+    };
+    std::vector<std::pair<node*, slot_place>> slots;
+    slots.emplace_back(nullptr, ROOT);
+
+    node* root = nullptr;
+    while (!slots.empty()) {
+        node* owner = slots.back().first;
+        slot_place place = slots.back().second;
+        slots.pop_back();
+
+        uint8_t flags = reader.read<uint8_t>();
+        if ((!(flags & FLAG_EXPR) && (flags & (FLAG_LEFT | FLAG_RIGHT | FLAG_FUNCTION))) || (ROOT != place && (flags & FLAG_DEFINES))) {
+            reader.fail();
+        }
+        node* nd = nullptr;
+        size_t items = 0;
+        if (flags & FLAG_EXPR) {
+            if (flags & FLAG_FUNCTION) {
+                string_t function = reader.read_string();
+                if (!reader.failed()) {
+                    nd = make_node(make_function(function));
+                    if (NO_SYMBOL == nd->expr.oper.function->name) {
+                        reader.fail();
+                    }
+                }
+            } else {
+                uint16_t code = reader.read<uint16_t>();
+                if (!reader.failed() && code <= operater::TRIPLE_INTEGRATE) {
+                    nd = make_node(make_operater(static_cast<operater::operater_code>(code)));
+                }
+            }
+        } else {
+            object obj = make_boolean(false);
+            switch (reader.read<uint8_t>()) {
+            case object::BOOLEAN:
+                obj = make_boolean(0 != reader.read<uint8_t>());
+                break;
+            case object::REAL:
+                obj = make_real(reader.read<real_t>());
+                break;
+            case object::IMAGINARY:
+                obj = make_imaginary(reader.read<real_t>());
+                break;
+            case object::STRING:
+                obj = make_string(reader.read_string());
+                break;
+            case object::PARAM:
+                obj = make_param(reader.read_string());
+                if (NO_SYMBOL == obj.param) {
+                    reader.fail();
+                }
+                break;
+            case object::VARIABLE:
+                obj = make_variable(static_cast<char_t>(reader.read<uint32_t>()));
+                break;
+            case object::ARRAY:
+                items = reader.read<uint32_t>();
+                if (reader.remaining() < items) {
+                    reader.fail();
+                    break;
+                }
+                obj = make_array(node_array());
+                obj.array->reserve(items);
+                break;
+            case object::REAL_ARRAY: {
+                size_t count = reader.read<uint32_t>();
+                if (reader.remaining() / sizeof(real_t) < count) {
+                    reader.fail();
+                    break;
+                }
+                real_array reals(count);
+                for (real_t& value : reals) {
+                    value = reader.read<real_t>();
+                }
+                obj = make_real_array(std::move(reals));
+                break;
+            }
+            default:
+                reader.fail();
+                break;
+            }
+            nd = make_node(obj);
+        }
+
+        if (!nd || reader.failed()) {
+            delete nd;
+            delete root;
+            return nullptr;
+        }
+
+        switch (place) {
+        case ROOT:
+            root = nd;
+            break;
+        case DEFINES:
+            owner->defines = nd;
+            break;
+        case LEFT:
+            owner->expr.left = nd;
+            nd->parent = owner;
+            break;
+        case RIGHT:
+            owner->expr.right = nd;
+            nd->parent = owner;
+            break;
+        case ITEM:
+            owner->obj.array->push_back(nd);
+            nd->super = owner;
+            break;
+        }
+
+        if (flags & FLAG_RIGHT) {
+            slots.emplace_back(nd, RIGHT);
+        }
+        if (flags & FLAG_LEFT) {
+            slots.emplace_back(nd, LEFT);
+        }
+        slots.insert(slots.end(), items, std::make_pair(nd, ITEM));
+        if (flags & FLAG_DEFINES) {
+            slots.emplace_back(nd, DEFINES);
+        }
+    }
+
+    if (reader.remaining()) {
+        delete root;
+        return nullptr;
+    }
+
+    return root;
+}
+
+void bundle_writer::add(const handler& hdl) {
+    m_blobs.push_back(hdl.save());
+    m_data.clear();
+}
+
+const std::string& bundle_writer::data() {
+    if (m_data.empty()) {
+        write_header(m_data, BUNDLE_MAGIC);
+        write_value<uint32_t>(m_data, static_cast<uint32_t>(m_blobs.size()));
+
+        uint64_t offset = m_data.size() + (m_blobs.size() + 1) * sizeof(uint64_t);
+        for (const std::string& blob : m_blobs) {
+            write_value(m_data, offset);
+            offset += blob.size();
+        }
+        write_value(m_data, offset);
+
+        for (const std::string& blob : m_blobs) {
+            m_data += blob;
+        }
+    }
+
+    return m_data;
+}
+
+bool bundle_writer::write(const std::string& path) {
+    const std::string& bytes = data();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    return file.write(bytes.data(), bytes.size()).good();
+}
+
+bundle::~bundle() {
+    close();
+}
+
+bool bundle::open(const std::string& path) {
+    close();
+
+#if defined(K_LINUX)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    void* mapping = MAP_FAILED;
+    if (0 == fstat(fd, &st) && 0 < st.st_size) {
+        mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+
+    if (MAP_FAILED == mapping) {
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_size = st.st_size;
+#elif defined(K_WINDOWS)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (INVALID_HANDLE_VALUE == file) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size = {};
+    HANDLE file_mapping = nullptr;
+    if (GetFileSizeEx(file, &file_size) && 0 < file_size.QuadPart) {
+        file_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    CloseHandle(file);
+
+    void* mapping = file_mapping ? MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (file_mapping) {
+        CloseHandle(file_mapping);
+    }
+
+    if (!mapping) {
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_size = static_cast<size_t>(file_size.QuadPart);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_size = m_buffer.size();
+#endif
+
+    if (!attach(m_mapping ? static_cast<const char*>(m_mapping) : m_buffer.data(), m_size)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool bundle::open(const char* data, size_t size) {
+    close();
+    return attach(data, size);
+}
+
+bool bundle::attach(const char* data, size_t size) {
+    blob_reader reader(data, size);
+    if (!reader.read_header(BUNDLE_MAGIC)) {
+        return false;
+    }
+
+    size_t count = reader.read<uint32_t>();
+    if (reader.failed() || reader.remaining() / sizeof(uint64_t) <= count) {
+        return false;
+    }
+
+    m_data = data;
+    m_size = size;
+    m_count = count;
+    return true;
+}
+
+void bundle::close() {
+#if defined(K_LINUX)
+    if (m_mapping) {
+        munmap(m_mapping, m_size);
+    }
+#elif defined(K_WINDOWS)
+    if (m_mapping) {
+        UnmapViewOfFile(m_mapping);
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_count = 0;
+    m_mapping = nullptr;
+    m_buffer.clear();
+}
+
+size_t bundle::size() const {
+    return m_count;
+}
+
+handler bundle::load(size_t index, library_ptr lib) const {
+    if (m_count <= index) {
+        return handler::load(nullptr, 0);
+    }
+
+    const char* table = m_data + sizeof(BUNDLE_MAGIC) + sizeof(BLOB_VERSION) + sizeof(BYTE_ORDER_MARK) + sizeof(uint32_t);
+    uint64_t begin = 0;
+    uint64_t end = 0;
+    memcpy(&begin, table + index * sizeof(uint64_t), sizeof(begin));
+    memcpy(&end, table + (index + 1) * sizeof(uint64_t), sizeof(end));
+    if (end < begin || m_size < end) {
+        return handler::load(nullptr, 0);
+    }
+
+    return handler::load(m_data + begin, static_cast<size_t>(end - begin), lib);
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EXPR_BLOB_H
+#define EXPR_BLOB_H
+
+#include "expr_handler.h"
+
+namespace expr {
+
+// blobs only load in the build that saved them
+void save_node(const node* nd, std::string& blob);
+node* load_node(const char* data, size_t size);
+
+class bundle_writer {
+public:
+    void add(const handler& hdl);
+    const std::string& data();
+    bool write(const std::string& path);
+
+private:
+    std::vector<std::string> m_blobs;
+    std::string m_data;
+};
+
+class bundle {
+public:
+    bundle() = default;
+    bundle(const bundle& other) = delete;
+    ~bundle();
+
+    bundle& operator=(const bundle& other) = delete;
+
+public:
+    bool open(const std::string& path);
+    bool open(const char* data, size_t size);
+    void close();
+    size_t size() const;
+    handler load(size_t index, library_ptr lib = nullptr) const;
+
+private:
+    bool attach(const char* data, size_t size);
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_count = 0;
+    void* m_mapping = nullptr;
+    std::string m_buffer;
+};
+
+}
+
+#endif
@@ -0,0 +1,156 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_cache.h"
+
+namespace expr {
+
+const size_t cache::DEFAULT_CAPACITY;
+const size_t cache::MAX_SOURCES;
+
+// failed positions of utf-8 and wide sources differ, so they are keyed apart
+static string_t source_key(const string_t& expr) {
+    return STR('w') + expr;
+}
+
+static string_t source_key(const std::string& expr) {
+    string_t key(1, STR('u'));
+    for (unsigned char ch : expr) {
+        key += static_cast<char_t>(ch);
+    }
+    return key;
+}
+
+cache::cache(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)) {}
+
+cache::handler_ptr cache::get(const string_t& expr) {
+    string_t source = source_key(expr);
+    handler_ptr hdl = lookup(source);
+    if (hdl) {
+        return hdl;
+    }
+
+    return insert(source, std::make_shared<handler>(expr));
+}
+
+cache::handler_ptr cache::get(const std::string& expr) {
+    string_t source = source_key(expr);
+    handler_ptr hdl = lookup(source);
+    if (hdl) {
+        return hdl;
+    }
+
+    return insert(source, std::make_shared<handler>(expr));
+}
+
+size_t cache::capacity() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+void cache::set_capacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = std::max<size_t>(capacity, 1);
+    evict();
+}
+
+cache::statistics cache::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return {m_hits, m_misses, m_evictions, m_entries.size()};
+}
+
+void cache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_sources.clear();
+    m_keys.clear();
+}
+
+cache& cache::global() {
+    static cache instance;
+    return instance;
+}
+
+cache::handler_ptr cache::lookup(const string_t& source) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_sources.find(source);
+    if (m_sources.end() == iter) {
+        ++m_misses;
+        return nullptr;
+    }
+
+    ++m_hits;
+    touch(iter->second);
+    return iter->second->hdl;
+}
+
+cache::handler_ptr cache::insert(const string_t& source, handler_ptr hdl) {
+    string_t key = hdl->is_valid() ? hdl->key() : string_t();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto source_iter = m_sources.find(source);
+    if (m_sources.end() != source_iter) {
+        touch(source_iter->second);
+        return source_iter->second->hdl;
+    }
+
+    auto key_iter = key.empty() ? m_keys.end() : m_keys.find(key);
+    if (m_keys.end() != key_iter) {
+        entry_list::iterator iter = key_iter->second;
+        if (iter->sources.size() < MAX_SOURCES) {
+            iter->sources.push_back(source);
+            m_sources.emplace(source, iter);
+        }
+        touch(iter);
+        return iter->hdl;
+    }
+
+    m_entries.push_front({hdl, key, {source}});
+    m_sources.emplace(source, m_entries.begin());
+    if (!key.empty()) {
+        m_keys.emplace(key, m_entries.begin());
+    }
+    evict();
+    return hdl;
+}
+
+void cache::touch(entry_list::iterator iter) {
+    m_entries.splice(m_entries.begin(), m_entries, iter);
+}
+
+void cache::evict() {
+    while (m_capacity < m_entries.size()) {
+        const entry& back = m_entries.back();
+        for (const string_t& source : back.sources) {
+            m_sources.erase(source);
+        }
+        if (!back.key.empty()) {
+            m_keys.erase(back.key);
+        }
+        m_entries.pop_back();
+        ++m_evictions;
+    }
+}
+
+}
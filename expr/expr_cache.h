@@ -0,0 +1,91 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EXPR_CACHE_H
+#define EXPR_CACHE_H
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "expr_handler.h"
+
+namespace expr {
+
+// thread-safe lru cache of parsed handlers
+class cache {
+public:
+    using handler_ptr = std::shared_ptr<const handler>;
+    struct statistics {
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+        size_t size;
+    };
+
+public:
+    explicit cache(size_t capacity = DEFAULT_CAPACITY);
+    cache(const cache& other) = delete;
+
+    cache& operator=(const cache& other) = delete;
+
+public:
+    handler_ptr get(const string_t& expr);
+    handler_ptr get(const std::string& expr);
+    size_t capacity() const;
+    void set_capacity(size_t capacity);
+    statistics stats() const;
+    void clear();
+
+    static cache& global();
+
+private:
+    struct entry {
+        handler_ptr hdl;
+        string_t key;
+        std::vector<string_t> sources;
+    };
+    using entry_list = std::list<entry>;
+
+    handler_ptr lookup(const string_t& source);
+    handler_ptr insert(const string_t& source, handler_ptr hdl);
+    void touch(entry_list::iterator iter);
+    void evict();
+
+private:
+    static const size_t DEFAULT_CAPACITY = 4096;
+    static const size_t MAX_SOURCES = 16;
+
+    mutable std::mutex m_mutex;
+    size_t m_capacity;
+    entry_list m_entries;
+    std::unordered_map<string_t, entry_list::iterator> m_sources;
+    std::unordered_map<string_t, entry_list::iterator> m_keys;
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+    size_t m_evictions = 0;
+};
+
+}
+
+#endif
@@ -25,7 +25,10 @@
 #ifndef EXPR_COMMON_H
 #define EXPR_COMMON_H
 
+#include <algorithm>
 #include <complex>
+#include <cstdlib>
+#include <cwchar>
 #include <string>
 #include <vector>
 #include <locale>
@@ -71,6 +74,13 @@ inline string_t to_string(real_t real) {
     return str;
 }
 
+// round-trips every value
+inline string_t to_exact_string(real_t real) {
+    char_t buffer[32] = {};
+    swprintf(buffer, sizeof(buffer) / sizeof(char_t), STR("%.17g"), real);
+    return buffer;
+}
+
 inline string_t to_string(const complex_t& complex) {
     real_t real = complex.real();
     real_t imag = complex.imag();
@@ -96,6 +106,74 @@ inline real_t to_real(const string_t& str) {
     return real;
 }
 
+// str holds the digits without sign or prefix and is null terminated
+inline real_t to_real(const char* str, size_t size, int radix = 10) {
+    if (10 != radix) {
+        unsigned long long integer = 0;
+        real_t real = 0;
+        bool overflow = false;
+        for (size_t index = 0; index < size; ++index) {
+            char ch = str[index];
+            int digit = ch <= '9' ? ch - '0' : (ch | 0x20) - 'a' + 10;
+            if (!overflow && integer <= (~0ull - digit) / radix) {
+                integer = integer * radix + digit;
+            } else {
+                real = (overflow ? real : real_t(integer)) * radix + digit;
+                overflow = true;
+            }
+        }
+
+        return overflow ? real : real_t(integer);
+    }
+
+    static const real_t powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool exact = true;
+    bool fraction = false;
+    size_t index = 0;
+    for (; index < size; ++index) {
+        char ch = str[index];
+        if ('.' == ch && !fraction) {
+            fraction = true;
+        } else if ('0' <= ch && ch <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (ch - '0');
+                digits += (0 != mantissa);
+                exponent -= fraction;
+            } else {
+                exact = false;
+            }
+        } else {
+            break;
+        }
+    }
+
+    if (index < size && ('e' == str[index] || 'E' == str[index])) {
+        bool negative = ++index < size && '-' == str[index];
+        if (index < size && ('-' == str[index] || '+' == str[index])) {
+            ++index;
+        }
+
+        int value = 0;
+        for (; index < size && '0' <= str[index] && str[index] <= '9'; ++index) {
+            value = std::min(value * 10 + (str[index] - '0'), 100000);
+        }
+        exponent += negative ? -value : value;
+    }
+
+    if (exact && mantissa <= (1ull << 53) && -22 <= exponent && exponent <= 22) {
+        return exponent < 0 ? real_t(mantissa) / powers[-exponent] : real_t(mantissa) * powers[exponent];
+    }
+
+    return std::strtod(str, nullptr);
+}
+
 inline std::string to_utf8(const string_t& str) {
     return std::wstring_convert<std::codecvt_utf8_utf16<char_t>>().to_bytes(str);
 }
@@ -104,6 +182,56 @@ inline string_t from_utf8(const std::string& str) {
     return std::wstring_convert<std::codecvt_utf8_utf16<char_t>>().from_bytes(str);
 }
 
+// decodes the char at pos and moves pos past it
+inline char_t decode_utf8(const char* str, size_t size, size_t& pos) {
+    auto byte = [str](size_t index) { return static_cast<unsigned char>(str[index]); };
+    auto follows = [&byte, size](size_t index) { return index < size && 0x80 == (byte(index) & 0xC0); };
+    auto decode4 = [&byte, &follows](size_t lead) -> unsigned long {
+        if (0xF0 <= byte(lead) && byte(lead) <= 0xF4 && follows(lead + 1) && follows(lead + 2) && follows(lead + 3)) {
+            unsigned long code = ((byte(lead) & 0x07ul) << 18) | ((byte(lead + 1) & 0x3Ful) << 12) |
+                                 ((byte(lead + 2) & 0x3Ful) << 6) | (byte(lead + 3) & 0x3Ful);
+            if (0x10000 <= code && code <= 0x10FFFF) {
+                return code;
+            }
+        }
+        return 0;
+    };
+
+    unsigned char lead = byte(pos);
+    if (lead < 0x80) {
+        ++pos;
+        return lead;
+    }
+
+    if (lead < 0xC0) {
+        unsigned long code = 2 <= pos ? decode4(pos - 2) : 0;
+        if (code) {
+            pos += 2;
+            return static_cast<char_t>(0xDC00 + ((code - 0x10000) & 0x3FF));
+        }
+    } else if (lead < 0xE0) {
+        if (0xC2 <= lead && follows(pos + 1)) {
+            char_t ch = static_cast<char_t>(((lead & 0x1F) << 6) | (byte(pos + 1) & 0x3F));
+            pos += 2;
+            return ch;
+        }
+    } else if (lead < 0xF0) {
+        if (follows(pos + 1) && follows(pos + 2)) {
+            unsigned long code = ((lead & 0x0Ful) << 12) | ((byte(pos + 1) & 0x3Ful) << 6) | (byte(pos + 2) & 0x3Ful);
+            if (0x800 <= code && (code < 0xD800 || 0xDFFF < code)) {
+                pos += 3;
+                return static_cast<char_t>(code);
+            }
+        }
+    } else if (unsigned long code = decode4(pos)) {
+        pos += 2;
+        return static_cast<char_t>(0xD800 + ((code - 0x10000) >> 10));
+    }
+
+    ++pos;
+    return static_cast<char_t>(0xFFFD);
+}
+
 inline size_t replace(string_t& str, const string_t& before, const string_t& after, bool once = true) {
     if (str.empty() || before.empty()) {
         return 0;
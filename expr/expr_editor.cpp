@@ -0,0 +1,171 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_editor.h"
+#include "expr_link.h"
+
+namespace expr {
+
+const size_t MAX_ARENA_GROWTH = 4;
+
+editor::editor(const string_t& text, library_ptr lib) : m_library(lib) {
+    reset(text);
+}
+
+bool editor::edit(size_t pos, size_t length, const string_t& text) {
+    pos = std::min(pos, m_text.size());
+    length = std::min(length, m_text.size() - pos);
+    m_text.replace(pos, length, text);
+
+    if (!m_handler.m_root || 1 < m_handler.m_arena.use_count() || MAX_ARENA_GROWTH * m_parsed < m_handler.m_arena->allocated() ||
+        !reparse_item(pos, length, text.size())) {
+        reparse();
+    }
+
+    return m_handler.is_valid();
+}
+
+void editor::reset(const string_t& text) {
+    m_text = text;
+    reparse();
+}
+
+const string_t& editor::text() const {
+    return m_text;
+}
+
+const handler& editor::current() const {
+    return m_handler;
+}
+
+bool editor::is_valid(size_t* failed_pos) const {
+    return m_handler.is_valid(failed_pos);
+}
+
+void editor::reparse() {
+    m_spans.clear();
+
+    handler hdl;
+    hdl.m_wide = m_text.data();
+    hdl.m_size = m_text.size();
+    hdl.m_spans = &m_spans;
+    hdl.m_library = m_library;
+    hdl.parse();
+    hdl.m_spans = nullptr;
+
+    m_handler = std::move(hdl);
+    m_dm = m_handler.m_root ? m_handler.resolve_defines(m_handler.m_root->defines) : nullptr;
+    m_parsed = m_handler.m_arena ? m_handler.m_arena->allocated() : 0;
+}
+
+bool editor::reparse_item(size_t pos, size_t length, size_t size) {
+    const handler::item_span* target = nullptr;
+    for (const handler::item_span& span : m_spans) {
+        if (span.begin <= pos && pos + length <= span.end && (!target || span.end - span.begin < target->end - target->begin)) {
+            target = &span;
+        }
+    }
+
+    if (!target) {
+        return false;
+    }
+
+    node* old_nd = target->nd;
+    node* super = old_nd->super;
+    if (!super || !super->is_array() || super->obj.array->size() <= target->index || (*super->obj.array)[target->index] != old_nd) {
+        return false;
+    }
+
+    const node* top = super;
+    while (top->upper()) {
+        top = top->upper();
+    }
+    bool is_define = (top == m_handler.m_root->defines);
+
+    size_t begin = target->begin;
+    size_t end = target->end + size - length;
+    size_t index = target->index;
+
+    arena::scope scope(m_handler.m_arena.get());
+    handler::span_list spans;
+    handler hdl;
+    hdl.m_wide = m_text.data() + begin;
+    hdl.m_size = end - begin;
+    hdl.m_spans = &spans;
+    node* nd = hdl.parse_frames(false, !is_define, m_dm);
+    if (!nd || !hdl.finished()) {
+        delete nd;
+        return false;
+    }
+
+    (*super->obj.array)[index] = nd;
+    nd->super = super;
+    old_nd->super = nullptr;
+
+    size_t old_begin = target->begin;
+    size_t old_end = target->end;
+    auto iter = std::remove_if(m_spans.begin(), m_spans.end(), [old_begin, old_end](const handler::item_span& span) {
+        return old_begin <= span.begin && span.end <= old_end;
+    });
+    m_spans.erase(iter, m_spans.end());
+    for (handler::item_span& span : m_spans) {
+        if (old_end <= span.begin) {
+            span.begin = span.begin + size - length;
+        }
+        if (old_end <= span.end) {
+            span.end = span.end + size - length;
+        }
+    }
+    m_spans.push_back({nd, index, begin, end});
+    for (handler::item_span& span : spans) {
+        m_spans.push_back({span.nd, span.index, span.begin + begin, span.end + begin});
+    }
+    delete old_nd;
+    m_handler.m_program = nullptr;
+
+    if (is_define) {
+        define_map_ptr dm = m_handler.resolve_defines(m_handler.m_root->defines);
+        auto names_equal = [](const define_map_ptr& dm1, const define_map_ptr& dm2) {
+            if (!dm1 || !dm2) {
+                return !dm1 == !dm2;
+            }
+            return dm1->fallback == dm2->fallback && dm1->size() == dm2->size() &&
+                   std::equal(dm1->begin(), dm1->end(), dm2->begin(), [](decltype(*dm1->begin())& p1, decltype(*dm2->begin())& p2) {
+                       return p1.first == p2.first;
+                   });
+        };
+
+        bool revalidate = !names_equal(dm, m_dm);
+        m_dm = dm;
+        if (revalidate && !test_node(m_handler.m_root, m_dm)) {
+            return false;
+        }
+
+        bind_node(m_handler.m_root, m_dm);
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,63 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EXPR_EDITOR_H
+#define EXPR_EDITOR_H
+
+#include "expr_handler.h"
+
+namespace expr {
+
+// reparses only the edited item where it can
+class editor {
+public:
+    explicit editor(const string_t& text = string_t(), library_ptr lib = nullptr);
+    editor(const editor& other) = delete;
+
+    editor& operator=(const editor& other) = delete;
+
+public:
+    bool edit(size_t pos, size_t length, const string_t& text);
+    void reset(const string_t& text);
+
+    const string_t& text() const;
+    const handler& current() const;
+    bool is_valid(size_t* failed_pos = nullptr) const;
+
+private:
+    void reparse();
+    bool reparse_item(size_t pos, size_t length, size_t size);
+
+private:
+    string_t m_text;
+    handler m_handler;
+    handler::span_list m_spans;
+    library_ptr m_library;
+    define_map_ptr m_dm;
+    size_t m_parsed = 0;
+};
+
+}
+
+#endif
@@ -24,8 +24,12 @@
 
 #include "expr_handler.h"
 #include <algorithm>
+#include "expr_blob.h"
 #include "expr_link.h"
+#include "expr_lexicon.h"
+#include "expr_library.h"
 #include "expr_operate.h"
+#include "expr_program.h"
 
 #define EXTRA_EXPR_NODE
 #include "extradefs.h"
@@ -34,30 +38,126 @@ namespace expr {
 
 enum class parse_state {
     SEGMENT_OPENING,
-    SEGMENT_CLOSED
+    SEGMENT_CLOSED,
+    GROUP_OPENED,
+    GROUP_ARRAY,
+    ARGUMENTS,
+    ARRAY_OPENING,
+    ITEM_OPENING,
+    ITEM_CLOSED
 };
 
-const size_t MAX_GENERATE_SIZE      = 10000000;
-const size_t INTEGRATE_PIECE_SIZE   = 1000000;
-const size_t INTEGRATE2_PIECE_SIZE  = 8000;
-const size_t INTEGRATE3_PIECE_SIZE  = 500;
+struct parse_frame {
+    parse_state state;
+    size_t ops;
+    bool boundary;
+    bool packed = false;
+    size_t begin = 0;
+    size_t item_begin = 0;
+    real_array reals;
+    node* root = nullptr;
+    node* semi = nullptr;
+    node* pending = nullptr;
+    node* current = nullptr;
+    node_array items;
 
-handler::handler(const string_t& expr) : m_expr(expr) {
-    node* defines = parse_defines();
-    node* root = parse_atom();
-    if (root) {
-        std::swap(root->defines, defines);
-    }
+    parse_frame(parse_state state, size_t ops, bool boundary) : state(state), ops(ops), boundary(boundary) {}
 
-    if (root && finished() && test_node(root)) {
-        m_root = root;
-    } else {
-        delete defines;
+    void clear() {
         delete root;
+        delete pending;
+        delete current;
+        for (node* item : items) {
+            delete item;
+        }
+        root = pending = current = nullptr;
+        items.clear();
+        reals.clear();
     }
+};
+
+node* unpack_reals(const node* nd) {
+    node_array items;
+    items.reserve(nd->obj.reals->size());
+    for (real_t value : *nd->obj.reals) {
+        node* item = make_node(make_real(fabs(value)));
+        if (std::signbit(value)) {
+            node* negative = make_node(make_operater(operater::NEGATIVE));
+            link_node(negative, node::RIGHT, item);
+            item = negative;
+        }
+        items.push_back(item);
+    }
+
+    node* array = make_node(make_array(items));
+    array->super = nd->super;
+    array->parent = nd->parent;
+    return array;
 }
 
-handler::handler(handler&& other) noexcept : m_expr(std::move(other.m_expr)), m_pos(other.m_pos), m_root(other.m_root) {
+class literal_text {
+public:
+    void append(char ch) {
+        if (m_size + 1 < sizeof(m_buffer)) {
+            m_buffer[m_size] = ch;
+            m_buffer[m_size + 1] = 0;
+        } else {
+            if (m_spill.empty()) {
+                m_spill.assign(m_buffer, m_size);
+            }
+            m_spill += ch;
+        }
+        ++m_size;
+    }
+
+    const char* data() const {
+        return m_spill.empty() ? m_buffer : m_spill.c_str();
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+    char m_buffer[64] = {};
+    size_t m_size = 0;
+    std::string m_spill;
+};
+
+inline bool is_digit(char_t ch, int radix) {
+    switch (radix) {
+    case 2:
+        return STR('0') == ch || STR('1') == ch;
+    case 16:
+        return STR('0') <= ch && ch <= STR('9') || STR('a') <= ch && ch <= STR('f') || STR('A') <= ch && ch <= STR('F');
+    }
+
+    return STR('0') <= ch && ch <= STR('9');
+}
+
+const size_t MIN_PACKED_SIZE        = 16;
+
+handler::handler(const string_t& expr, library_ptr lib) : handler(expr.data(), expr.size(), lib) {}
+
+handler::handler(const std::string& expr, library_ptr lib) : handler(expr.data(), expr.size(), lib) {}
+
+handler::handler(const char_t* expr, size_t size, library_ptr lib) : m_wide(expr), m_size(size), m_library(lib) {
+    parse();
+}
+
+handler::handler(const char* expr, size_t size, library_ptr lib) : m_utf8(expr), m_size(size), m_library(lib) {
+    parse();
+}
+
+handler::handler(node* root) : m_root(root) {}
+
+handler::handler(const handler& other)
+    : m_pos(other.m_pos), m_root(other.m_root), m_arena(other.m_arena), m_library(other.m_library), m_level(other.m_level),
+      m_program(std::atomic_load(&other.m_program)) {}
+
+handler::handler(handler&& other) noexcept
+    : m_pos(other.m_pos), m_root(other.m_root), m_arena(std::move(other.m_arena)), m_library(std::move(other.m_library)),
+      m_level(other.m_level), m_program(std::move(other.m_program)) {
     other.m_root = nullptr;
 }
 
@@ -65,16 +165,67 @@ handler::~handler() {
     delete m_root;
 }
 
+handler& handler::operator=(const handler& other) {
+    if (this != &other) {
+        handler copy(other);
+        *this = std::move(copy);
+    }
+
+    return *this;
+}
+
 handler& handler::operator=(handler&& other) noexcept {
     if (this != &other) {
-        std::swap(m_expr, other.m_expr);
         m_pos = other.m_pos;
         std::swap(m_root, other.m_root);
+        std::swap(m_arena, other.m_arena);
+        std::swap(m_library, other.m_library);
+        std::swap(m_level, other.m_level);
+        std::swap(m_program, other.m_program);
     }
 
     return *this;
 }
 
+void handler::parse() {
+    m_arena = std::make_shared<arena>();
+    arena::scope scope(m_arena.get());
+
+    node* defines = parse_defines();
+    define_map_ptr dm = resolve_defines(defines);
+    node* root = parse_atom(dm);
+    if (root) {
+        std::swap(root->defines, defines);
+    }
+
+    if (root && finished()) {
+        bind_node(root->defines, dm);
+        m_root = root;
+    } else {
+        delete defines;
+        delete root;
+        m_arena = nullptr;
+        if (m_spans) {
+            m_spans->clear();
+        }
+    }
+
+    m_wide = nullptr;
+    m_utf8 = nullptr;
+    m_size = 0;
+}
+
+define_map_ptr handler::resolve_defines(const node* defines) const {
+    define_map_ptr dm = node::make_define_map(defines);
+    define_map_ptr shared = m_library ? m_library->define_map() : nullptr;
+    if (!dm) {
+        return shared;
+    }
+
+    dm->fallback = shared;
+    return dm;
+}
+
 bool handler::is_valid(size_t* failed_pos) const {
     if (m_root) {
         return true;
@@ -91,6 +242,10 @@ string_t handler::expr() const {
     return expr(m_root);
 }
 
+string_t handler::key() const {
+    return expr(m_root, true);
+}
+
 string_t handler::latex() const {
     return latex(m_root);
 }
@@ -100,19 +255,81 @@ string_t handler::tree(size_t indent) const {
 }
 
 variant handler::calc(const calc_assist& assist) const {
-    static unsigned s = 0;
-    if (!s) {
-        s = (unsigned)time(nullptr);
-        srand(s);
+    return compile()->calc(assist);
+}
+
+string_array handler::params() const {
+    string_array names;
+    for (symbol_t param : compile()->params()) {
+        names.push_back(symbol_name(param));
     }
 
-    variant res = calc(m_root, assist);
-    return res.is_complex() && 0 == res.complex->imag() ? res.complex->real() : res;
+    return names;
+}
+
+program_ptr handler::compile() const {
+    program_ptr pg = std::atomic_load(&m_program);
+    if (!pg) {
+        std::shared_ptr<program> built = std::make_shared<program>(m_root);
+        built->fold_constants();
+        if (REDUCE <= m_level) {
+            built->reduce_strength();
+            built->eliminate_common();
+        }
+        if (TYPED <= m_level) {
+            built->infer_types();
+        }
+        if (NATIVE <= m_level) {
+            built->compile_native();
+        }
+        pg = built;
+        std::atomic_store(&m_program, pg);
+    }
+
+    return pg;
+}
+
+void handler::optimize(optimize_level level) {
+    if (level != m_level) {
+        m_level = level;
+        m_program = nullptr;
+    }
+}
+
+handler::optimize_level handler::optimization() const {
+    return m_level;
+}
+
+std::string handler::save() const {
+    std::string blob;
+    if (m_root) {
+        save_node(m_root, blob);
+    }
+
+    return blob;
+}
+
+handler handler::load(const void* blob, size_t size, library_ptr lib) {
+    arena_ptr pool = std::make_shared<arena>();
+    arena::scope scope(pool.get());
+    handler hdl(blob ? load_node(static_cast<const char*>(blob), size) : nullptr);
+    hdl.m_arena = hdl.m_root ? pool : nullptr;
+    hdl.m_library = lib;
+    if (hdl.m_root) {
+        define_map_ptr dm = hdl.resolve_defines(hdl.m_root->defines);
+        if ((hdl.m_root->defines && !hdl.m_root->defines->is_array()) || !test_node(hdl.m_root, dm)) {
+            return handler();
+        }
+        bind_node(hdl.m_root, dm);
+    }
+
+    return hdl;
 }
 
 char_t handler::get_char(bool skip_space) {
-    while (m_pos < m_expr.size()) {
-        char_t ch = m_expr[m_pos++];
+    while (m_pos < m_size) {
+        m_prev = m_pos;
+        char_t ch = m_utf8 ? decode_utf8(m_utf8, m_size, m_pos) : m_wide[m_pos++];
         if (!skip_space || !(STR('\t') <= ch && ch <= STR('\r') || STR(' ') == ch)) {
             return ch;
         }
@@ -121,10 +338,14 @@ char_t handler::get_char(bool skip_space) {
     return 0;
 }
 
+void handler::unget_char() {
+    m_pos = m_prev;
+}
+
 char_t handler::peek_char() {
     char_t ch = get_char();
     if (ch) {
-        --m_pos;
+        unget_char();
     }
 
     return ch;
@@ -146,6 +367,26 @@ bool handler::try_match(const string_t& str) {
     return true;
 }
 
+template<class value_t>
+bool handler::try_match(const lexicon<value_t>& lex, value_t& value) {
+    size_t pos = m_pos;
+    size_t matched_pos = pos;
+    size_t state = 0;
+    while (char_t ch = get_char()) {
+        state = lex.next(state, ch);
+        if (lexicon<value_t>::npos == state) {
+            break;
+        }
+
+        if (lex.accept(state, value)) {
+            matched_pos = m_pos;
+        }
+    }
+
+    m_pos = matched_pos;
+    return pos != matched_pos;
+}
+
 bool handler::atom_ended() {
     char_t ch = peek_char();
     return !ch || STR(',') == ch || STR(')') == ch || STR('}') == ch;
@@ -161,114 +402,228 @@ node* handler::parse_defines() {
         return nullptr;
     }
 
-    node* nd = parse_array(false);
+    size_t spans = m_spans ? m_spans->size() : 0;
+    node* nd = parse_array();
     if (!try_match(STR("}")) || !nd || nd->obj.array->empty()) {
         delete nd;
+        if (m_spans) {
+            m_spans->resize(spans);
+        }
         return nullptr;
     }
 
     return nd;
 }
 
-node* handler::parse_atom() {
-    node* root = nullptr;
-    node* semi = nullptr;
-    node* pending = nullptr;
-    node* current = nullptr;
-    parse_state state = parse_state::SEGMENT_OPENING;
+node* handler::parse_atom(const define_map_ptr& dm) {
+    return parse_frames(false, true, dm);
+}
+
+node* handler::parse_array() {
+    return parse_frames(true, false, nullptr);
+}
+
+node* handler::parse_frames(bool array, bool validate, const define_map_ptr& dm) {
+    std::vector<parse_frame> frames;
+    size_t spans = m_spans ? m_spans->size() : 0;
+    node_array ops;
+    node* result = nullptr;
+
+    auto close_array = [this](parse_frame& frame) -> node* {
+        if (frame.packed && frame.reals.size() < MIN_PACKED_SIZE) {
+            frame.packed = false;
+            frame.reals.clear();
+            frame.state = parse_state::ITEM_OPENING;
+            m_pos = frame.begin;
+            return nullptr;
+        }
+
+        node* nd = make_node(frame.packed ? make_real_array(std::move(frame.reals)) : make_array(frame.items));
+        frame.reals.clear();
+        frame.items.clear();
+        return nd;
+    };
+    frames.emplace_back(array ? parse_state::ARRAY_OPENING : parse_state::SEGMENT_OPENING, ops.size(), false);
     while (true) {
-        switch (state) {
+        parse_frame& frame = frames.back();
+        switch (frame.state) {
         case parse_state::SEGMENT_OPENING:
             if (try_match(STR("("))) {
-                pending = parse_atom();
-                if (!pending) {
+                frame.state = parse_state::GROUP_OPENED;
+                frames.emplace_back(parse_state::SEGMENT_OPENING, ops.size(), false);
+                continue;
+            }
+
+            frame.current = parse_operater(operater::UNARY);
+            if (frame.current) {
+                if (frame.current->expr.oper.postpose) {
                     goto failed;
                 }
 
-                if (try_match(STR(","))) {
-                    node* nd = parse_array(false);
-                    if (!nd) {
-                        goto failed;
-                    }
+                node* current = frame.current;
+                bool need_array =
+                    current->is_evaluation() || current->is_invocation() || current->is_largescale() || current->is_function();
 
-                    nd->obj.array->insert(nd->obj.array->begin(), pending);
-                    pending->super = nd;
-                    pending = nd;
-                }
-                if (!try_match(STR(")"))) {
+                if (!insert_node(frame.root, frame.semi, frame.pending, frame.current)) {
                     goto failed;
                 }
-                state = parse_state::SEGMENT_CLOSED;
-            } else {
-                current = parse_operater(operater::UNARY);
-                if (current) {
-                    if (current->expr.oper.postpose) {
-                        goto failed;
-                    }
-
-                    bool need_array =
-                        current->is_evaluation() || current->is_invocation() || current->is_largescale() || current->is_function();
+                ops.push_back(current);
 
-                    if (!insert_node(root, semi, pending, current)) {
-                        goto failed;
-                    }
-
-                    if (need_array) {
-                        pending = parse_array(true);
-                        if (!pending) {
-                            goto failed;
-                        }
-                        state = parse_state::SEGMENT_CLOSED;
-                    }
-                } else {
-                    pending = parse_object();
-                    if (!pending) {
-                        goto failed;
-                    }
-                    state = parse_state::SEGMENT_CLOSED;
+                if (need_array) {
+                    frame.state = parse_state::ARGUMENTS;
+                    frames.emplace_back(parse_state::ARRAY_OPENING, ops.size(), true);
+                    frames.back().packed = current->is_evaluation();
+                    continue;
+                }
+            } else {
+                frame.pending = parse_object();
+                if (!frame.pending) {
+                    goto failed;
                 }
+                frame.state = parse_state::SEGMENT_CLOSED;
             }
             break;
+        case parse_state::GROUP_OPENED:
+            frame.pending = result;
+            result = nullptr;
+            if (try_match(STR(","))) {
+                frame.state = parse_state::GROUP_ARRAY;
+                parse_frame items(parse_state::ITEM_OPENING, ops.size(), false);
+                items.items.push_back(frame.pending);
+                frame.pending = nullptr;
+                frames.push_back(std::move(items));
+                continue;
+            }
+            if (!try_match(STR(")"))) {
+                goto failed;
+            }
+            frame.state = parse_state::SEGMENT_CLOSED;
+            break;
+        case parse_state::GROUP_ARRAY:
+            frame.pending = result;
+            result = nullptr;
+            if (!try_match(STR(")"))) {
+                goto failed;
+            }
+            frame.state = parse_state::SEGMENT_CLOSED;
+            break;
+        case parse_state::ARGUMENTS:
+            frame.pending = result;
+            result = nullptr;
+            frame.state = parse_state::SEGMENT_CLOSED;
+            break;
         case parse_state::SEGMENT_CLOSED:
             if (atom_ended()) {
-                if (!insert_node(root, semi, pending, current = nullptr)) {
+                if (!insert_node(frame.root, frame.semi, frame.pending, frame.current = nullptr)) {
                     goto failed;
                 }
-                return root;
+
+                if (validate) {
+                    for (size_t index = frame.ops; index < ops.size(); ++index) {
+                        node* op = ops[index];
+                        if (!test_link(op, node::LEFT, op->expr.left, dm) || !test_link(op, node::RIGHT, op->expr.right, dm)) {
+                            goto failed;
+                        }
+                        bind_function(op, dm);
+                    }
+                }
+                ops.resize(frame.ops);
+
+                result = frame.root;
+                frame.root = nullptr;
+                break;
             }
 
-            current = parse_operater(operater::BINARY);
-            if (current) {
-                if (!insert_node(root, semi, pending, current)) {
+            frame.current = parse_operater(operater::BINARY);
+            if (frame.current) {
+                node* current = frame.current;
+                if (!insert_node(frame.root, frame.semi, frame.pending, frame.current)) {
                     goto failed;
                 }
-                state = parse_state::SEGMENT_OPENING;
+                ops.push_back(current);
+                frame.state = parse_state::SEGMENT_OPENING;
             } else {
-                current = parse_operater(operater::UNARY);
-                if (!current || !current->expr.oper.postpose || !insert_node(root, semi, pending, current)) {
+                frame.current = parse_operater(operater::UNARY);
+                node* current = frame.current;
+                if (!current || !current->expr.oper.postpose || !insert_node(frame.root, frame.semi, frame.pending, frame.current)) {
                     goto failed;
                 }
+                ops.push_back(current);
+            }
+            continue;
+        case parse_state::ARRAY_OPENING:
+            if (frame.boundary && !try_match(STR("("))) {
+                goto failed;
+            }
+            frame.begin = m_pos;
+            frame.state = parse_state::ITEM_OPENING;
+            continue;
+        case parse_state::ITEM_OPENING:
+            if (frame.boundary && try_match(STR(")"))) {
+                result = close_array(frame);
+                break;
+            }
+            if (frame.packed) {
+                real_t num = 0;
+                if (scan_packed(num)) {
+                    frame.reals.push_back(num);
+                    frame.state = parse_state::ITEM_CLOSED;
+                    continue;
+                }
+
+                frame.packed = false;
+                frame.reals.clear();
+                m_pos = frame.begin;
+                continue;
+            }
+            frame.item_begin = m_pos;
+            frame.state = parse_state::ITEM_CLOSED;
+            frames.emplace_back(parse_state::SEGMENT_OPENING, ops.size(), false);
+            continue;
+        case parse_state::ITEM_CLOSED:
+            if (result) {
+                if (m_spans) {
+                    m_spans->push_back({result, frame.items.size(), frame.item_begin, m_pos});
+                }
+                frame.items.push_back(result);
+                result = nullptr;
+            }
+            if (try_match(STR(","))) {
+                frame.state = parse_state::ITEM_OPENING;
+                continue;
             }
+            if (frame.boundary && !try_match(STR(")"))) {
+                goto failed;
+            }
+            result = close_array(frame);
             break;
         default:
             goto failed;
         }
+
+        if (result) {
+            frames.pop_back();
+            if (frames.empty()) {
+                return result;
+            }
+        }
     }
 
 failed:
-    delete root;
-    delete pending;
-    delete current;
+    delete result;
+    for (parse_frame& frame : frames) {
+        frame.clear();
+    }
+    if (m_spans) {
+        m_spans->resize(spans);
+    }
     return nullptr;
 }
 
 node* handler::parse_operater(operater::operater_kind kind) {
-    for (auto iter = EXTRA_OPERATER_CODE.rbegin(); EXTRA_OPERATER_CODE.rend() != iter; ++iter) {
-        if (kind == iter->second.integer(operater::KIND)) {
-            if (try_match(iter->second.string(operater::NAME)) || try_match(iter->second.string(operater::ALIAS))) {
-                return make_node(make_operater(iter->first));
-            }
-        }
+    operater::operater_code code;
+    if (try_match(operater_lexicon(kind), code)) {
+        return make_node(make_operater(code));
     }
 
     return operater::UNARY == kind ? parse_function() : nullptr;
@@ -289,7 +644,7 @@ node* handler::parse_function() {
     }
 
     if (ch) {
-        --m_pos;
+        unget_char();
     }
 
     if (str.empty() || STR('(') != peek_char()) {
@@ -297,7 +652,14 @@ node* handler::parse_function() {
         return nullptr;
     }
 
-    return make_node(make_function(str));
+    node* nd = make_node(make_function(str));
+    if (NO_SYMBOL == nd->expr.oper.function->name) {
+        delete nd;
+        m_pos = pos;
+        return nullptr;
+    }
+
+    return nd;
 }
 
 node* handler::parse_object() {
@@ -318,20 +680,19 @@ node* handler::parse_object() {
 }
 
 node* handler::parse_constant() {
-    for (auto iter = EXTRA_OBJECT_CONSTANT.rbegin(); EXTRA_OBJECT_CONSTANT.rend() != iter; ++iter) {
-        if (try_match(iter->second.string(object::NAME)) || try_match(iter->second.string(object::ALIAS))) {
-            switch (iter->first) {
-            case object::CONST_FALSE:
-                return make_node(make_boolean(false));
-            case object::CONST_TRUE:
-                return make_node(make_boolean(true));
-            case object::CONST_INFINITY:
-                return make_node(make_real(INFINITY));
-            case object::CONST_PI:
-                return make_node(make_real(REAL_PI));
-            case object::CONST_E:
-                return make_node(make_real(REAL_E));
-            }
+    object::object_constant constant;
+    if (try_match(constant_lexicon(), constant)) {
+        switch (constant) {
+        case object::CONST_FALSE:
+            return make_node(make_boolean(false));
+        case object::CONST_TRUE:
+            return make_node(make_boolean(true));
+        case object::CONST_INFINITY:
+            return make_node(make_real(INFINITY));
+        case object::CONST_PI:
+            return make_node(make_real(REAL_PI));
+        case object::CONST_E:
+            return make_node(make_real(REAL_E));
         }
     }
 
@@ -339,55 +700,114 @@ node* handler::parse_constant() {
 }
 
 node* handler::parse_numeric() {
+    real_t num = 0;
+    bool is_imag = false;
+    if (!scan_numeric(num, is_imag)) {
+        return nullptr;
+    }
+
+    return make_node(is_imag ? make_imaginary(num) : make_real(num));
+}
+
+bool handler::scan_numeric(real_t& num, bool& is_imag) {
     size_t pos = m_pos;
     peek_char();
 
-    string_t str;
-    char_t ch;
-    while (ch = get_char(false)) {
-        if (STR('0') <= ch && ch <= STR('9') || STR('.') == ch || STR('i') == ch) {
-            str += ch;
+    literal_text text;
+    int radix = 10;
+    size_t mark = m_pos;
+    if (STR('0') == get_char(false)) {
+        char_t prefix = get_char(false);
+        radix = (STR('x') == prefix || STR('X') == prefix ? 16 : (STR('b') == prefix || STR('B') == prefix ? 2 : 10));
+        size_t digit = m_pos;
+        if (10 != radix && !is_digit(get_char(false), radix)) {
+            radix = 10;
+        }
+        m_pos = digit;
+    }
+
+    if (10 == radix) {
+        m_pos = mark;
+    }
+
+    auto scan_digits = [this, &text](int radix) {
+        size_t count = 0;
+        char_t ch;
+        while (ch = get_char(false)) {
+            if (!is_digit(ch, radix)) {
+                unget_char();
+                break;
+            }
+            text.append(static_cast<char>(ch));
+            ++count;
+        }
+        return count;
+    };
+
+    size_t digits = scan_digits(radix);
+    if (10 == radix) {
+        mark = m_pos;
+        if (STR('.') == get_char(false)) {
+            text.append('.');
+            digits += scan_digits(radix);
         } else {
-            break;
+            m_pos = mark;
+        }
+
+        mark = m_pos;
+        char_t ch = get_char(false);
+        if (digits && (STR('e') == ch || STR('E') == ch)) {
+            text.append('e');
+            char_t sign = get_char(false);
+            if (STR('-') == sign || STR('+') == sign) {
+                text.append(static_cast<char>(sign));
+            } else if (sign) {
+                unget_char();
+            }
+            if (!scan_digits(radix)) {
+                m_pos = mark;
+            }
+        } else {
+            m_pos = mark;
         }
     }
 
-    if (ch) {
-        --m_pos;
+    mark = m_pos;
+    is_imag = STR('i') == get_char(false);
+    if (!is_imag) {
+        m_pos = mark;
     }
 
-    if (str.empty() || 1 < std::count(str.begin(), str.end(), STR('.'))) {
+    if (!digits && !is_imag) {
         m_pos = pos;
-        return nullptr;
+        return false;
     }
 
-    bool is_imag;
-    switch (std::count(str.begin(), str.end(), STR('i'))) {
-    case 0:
-        is_imag = false;
-        break;
-    case 1:
-        if (STR('i') != str.back()) {
-            m_pos = pos;
-            return nullptr;
+    num = digits ? to_real(text.data(), text.size(), radix) : 1;
+    return true;
+}
+
+bool handler::scan_packed(real_t& num) {
+    size_t pos = m_pos;
+    bool negative = try_match(STR("-"));
+    bool is_imag = false;
+    if (scan_numeric(num, is_imag) && !is_imag) {
+        char_t ch = peek_char();
+        if (STR(',') == ch || STR(')') == ch) {
+            num = negative ? -num : num;
+            return true;
         }
-        is_imag = true;
-        str.pop_back();
-        break;
-    default:
-        m_pos = pos;
-        return nullptr;
     }
 
-    real_t num = str.empty() ? 1 : to_real(str);
-    return make_node(is_imag ? make_imaginary(num) : make_real(num));
+    m_pos = pos;
+    return false;
 }
 
 node* handler::parse_string() {
     char_t mark = get_char();
     if (STR('\"') != mark && STR('\'') != mark) {
         if (mark) {
-            --m_pos;
+            unget_char();
         }
 
         return nullptr;
@@ -412,6 +832,7 @@ node* handler::parse_string() {
 }
 
 node* handler::parse_param() {
+    size_t pos = m_pos;
     if (!try_match(STR("["))) {
         return nullptr;
     }
@@ -431,7 +852,14 @@ node* handler::parse_param() {
         return nullptr;
     }
 
-    return make_node(make_param(str));
+    node* nd = make_node(make_param(str));
+    if (NO_SYMBOL == nd->obj.param) {
+        delete nd;
+        m_pos = pos;
+        return nullptr;
+    }
+
+    return nd;
 }
 
 node* handler::parse_variable() {
@@ -441,51 +869,13 @@ node* handler::parse_variable() {
     }
 
     if (ch) {
-        --m_pos;
+        unget_char();
     }
 
     return nullptr;
 }
 
-node* handler::parse_array(bool boundary) {
-    if (boundary && !try_match(STR("("))) {
-        return nullptr;
-    }
-
-    node_array array;
-    bool closed = false;
-    bool failed = false;
-    while (true) {
-        if (boundary && try_match(STR(")"))) {
-            closed = true;
-            break;
-        }
-
-        node* item = parse_atom();
-        if (!item) {
-            failed = true;
-            break;
-        }
-
-        array.push_back(item);
-
-        if (!try_match(STR(","))) {
-            closed = boundary && try_match(STR(")"));
-            break;
-        }
-    }
-
-    if ((boundary && !closed) || failed) {
-        for (node* item : array) {
-            delete item;
-        }
-        return nullptr;
-    }
-
-    return make_node(make_array(array));
-}
-
-string_t handler::text(const node* nd) {
+string_t handler::text(const node* nd, bool exact) {
     if (!nd) {
         return string_t();
     }
@@ -494,9 +884,9 @@ string_t handler::text(const node* nd) {
         real_t abs = fabs(num);
         string_t str;
         if (approach_to(abs, REAL_PI)) {
-            str = EXTRA_OBJECT_CONSTANT.string(object::CONST_PI, object::NAME);
+            str = EXTRA_OBJECT_CONSTANT[object::CONST_PI].name;
         } else if (approach_to(abs, REAL_E)) {
-            str = EXTRA_OBJECT_CONSTANT.string(object::CONST_E, object::NAME);
+            str = EXTRA_OBJECT_CONSTANT[object::CONST_E].name;
         }
         if (!str.empty() && num < 0) {
             str = STR('-') + str;
@@ -510,43 +900,65 @@ string_t handler::text(const node* nd) {
         case object::BOOLEAN:
             return to_string(nd->obj.boolean);
         case object::REAL: {
+            if (exact) {
+                return to_exact_string(nd->obj.real);
+            }
             string_t str = constant_text(nd->obj.real);
             return !str.empty() ? str : to_string(nd->obj.real);
         }
         case object::IMAGINARY: {
+            if (exact) {
+                return to_exact_string(nd->obj.imaginary) + STR('i');
+            }
             string_t str = constant_text(nd->obj.imaginary);
             return !str.empty() ? str + STR('i') : to_string(complex_t(0, nd->obj.imaginary));
         }
-        case object::STRING:
-            return format(STR("\"%1\""), *nd->obj.string);
+        case object::STRING: {
+            const string_t& name = *nd->obj.string;
+            if (!exact) {
+                return format(STR("\"%1\""), name);
+            }
+            string_t str(1, STR('\"'));
+            for (char_t ch : name) {
+                if (STR('\"') == ch || STR('\\') == ch) {
+                    str += STR('\\');
+                }
+                str += ch;
+            }
+            return str + STR('\"');
+        }
         case object::PARAM:
-            return format(STR("[%1]"), *nd->obj.param);
+            return format(STR("[%1]"), symbol_name(nd->obj.param));
         case object::VARIABLE:
             return string_t(1, nd->obj.variable);
         case object::ARRAY: {
             const node_array& na = *nd->obj.array;
             string_array sa(na.size());
-            std::transform(na.begin(), na.end(), sa.begin(), [](const node* nd) { return expr(nd); });
+            std::transform(na.begin(), na.end(), sa.begin(), [exact](const node* nd) { return expr(nd, exact); });
             return format(STR("(%1)"), join(sa, STR(",")));
         }
+        case object::REAL_ARRAY: {
+            std::unique_ptr<node> array(unpack_reals(nd));
+            return text(array.get(), exact);
+        }
         }
         break;
     case node::EXPR:
-        return nd->is_function() ? *nd->expr.oper.function : EXTRA_OPERATER_CODE.string(nd->expr.oper.code, operater::NAME);
+        return nd->is_function() ? symbol_name(nd->expr.oper.function->name) : EXTRA_OPERATER_CODE[nd->expr.oper.code].name;
     }
 
     return string_t();
 }
 
-string_t handler::expr(const node* nd) {
+string_t handler::expr(const node* nd, bool exact) {
     if (!nd) {
         return string_t();
     }
 
-    string_t str = text(nd);
+    string_t str = text(nd, exact);
     if (nd->is_expr()) {
-        string_t left = expr(nd->expr.left);
-        string_t right = expr(nd->expr.right);
+        string_t left = expr(nd->expr.left, exact);
+        string_t right = expr(nd->expr.right, exact);
         if (nd->expr.left && nd->higher_than(nd->expr.left)) {
             left = format(STR("(%1)"), left);
         }
@@ -557,7 +969,7 @@ string_t handler::expr(const node* nd) {
     }
 
     if (nd->defines) {
-        string_t defines_str = expr(nd->defines);
+        string_t defines_str = expr(nd->defines, exact);
         if (!defines_str.empty()) {
             defines_str.front() = STR('{');
             defines_str.back() = STR('}');
@@ -585,7 +997,8 @@ string_t handler::latex(const node* nd) {
         case object::IMAGINARY: {
             str = text(nd);
             for (auto& pair : {std::make_pair(object::CONST_INFINITY, STR("\\infty ")), std::make_pair(object::CONST_PI, STR("\\pi "))}) {
-                for (auto& name : EXTRA_OBJECT_CONSTANT.at(pair.first)) {
+                const extra_object_constant& constant = EXTRA_OBJECT_CONSTANT[pair.first];
+                for (const char_t* name : {constant.name, constant.alias}) {
                     if (replace(str, name, pair.second)) {
                         goto done;
                     }
@@ -598,7 +1011,7 @@ string_t handler::latex(const node* nd) {
             str = format(STR("``%1\""), *nd->obj.string);
             break;
         case object::PARAM:
-            str = format(STR("\\left[%1\\right]"), *nd->obj.param);
+            str = format(STR("\\left[%1\\right]"), symbol_name(nd->obj.param));
             break;
         case object::ARRAY: {
             const node_array& na = *nd->obj.array;
@@ -607,6 +1020,11 @@ string_t handler::latex(const node* nd) {
             str = format(STR("\\left(%1\\right)"), join(sa, STR(",")));
             break;
         }
+        case object::REAL_ARRAY: {
+            std::unique_ptr<node> array(unpack_reals(nd));
+            str = latex(array.get());
+            break;
+        }
         }
         break;
     }
@@ -733,7 +1151,7 @@ string_t handler::latex(const node* nd) {
                 if (nd->expr.right && nd->expr.right->is_array()) {
                     const node_array& wrap = *nd->expr.right->obj.array;
                     if (3 <= wrap.size()) {
-                        string_t name = EXTRA_OPERATER_CODE.string(nd->expr.oper.code, operater::ALIAS);
+                        string_t name = EXTRA_OPERATER_CODE[nd->expr.oper.code].alias;
                         string_t variable = wrap[2]->function_variables();
                         if (!variable.empty()) {
                             variable.replace(variable.begin() + 1, variable.end(), STR("="));
@@ -812,6 +1230,11 @@ string_t handler::tree(const node* nd, size_t indent) {
         return string_t();
     }
 
+    if (nd->is_real_array()) {
+        std::unique_ptr<node> array(unpack_reals(nd));
+        return tree(array.get(), indent);
+    }
+
     string_t str = STR("─── ") + (nd->is_array() ? STR("array") : text(nd));
     if (nd->upper()) {
         node::node_side side = nd->side();
@@ -843,427 +1266,4 @@ string_t handler::tree(const node* nd, size_t indent) {
     return str;
 }
 
-variant handler::calc(const node* nd, const calc_assist& assist) {
-    if (!nd) {
-        return variant();
-    }
-
-    if (!assist.dm) {
-        assist.dm = nd->define_map();
-    }
-
-    switch (nd->type) {
-    case node::OBJECT:
-        return calc_object(nd, assist);
-    case node::EXPR:
-        switch (nd->expr.oper.type) {
-        case operater::INVOCATION:
-        case operater::LARGESCALE:
-            return calc_calls(nd, assist);
-        case operater::FUNCTION:
-            return calc_function(nd, assist);
-        }
-        return operate(calc(nd->expr.left, assist), nd->expr.oper, calc(nd->expr.right, assist));
-    }
-
-    return variant();
-}
-
-variant handler::calc_object(const node* nd, const calc_assist& assist) {
-    switch (nd->obj.type) {
-    case object::BOOLEAN:
-        return nd->obj.boolean;
-    case object::REAL:
-        return nd->obj.real;
-    case object::IMAGINARY:
-        return complex_t(0, nd->obj.imaginary);
-    case object::STRING:
-        return *nd->obj.string;
-    case object::PARAM:
-        return assist.pr ? assist.pr(*nd->obj.param) : variant();
-    case object::VARIABLE:
-        return assist.vr ? assist.vr(nd->obj.variable) : variant();
-    case object::ARRAY: {
-        const node_array& na = *nd->obj.array;
-        sequence_t sequence(na.size());
-        std::transform(na.begin(), na.end(), sequence.begin(), [&assist](const node* nd) { return calc(nd, assist); });
-        return sequence;
-    }
-    }
-
-    return variant();
-}
-
-variant handler::calc_function(const node* nd, const calc_assist& assist) {
-    if (!assist.dm) {
-        return variant();
-    }
-
-    auto iter = assist.dm->find(*nd->expr.oper.function);
-    if (assist.dm->end() == iter) {
-        return variant();
-    }
-
-    variant right = calc(nd->expr.right, assist);
-    if (!right.is_sequence()) {
-        return variant();
-    }
-
-    const string_t& variables = iter->second.first;
-    const node* rule = iter->second.second;
-    const sequence_t& args = *right.sequence;
-    variable_replacer vr = [&variables, &args](char_t variable) {
-        size_t pos = variables.find(variable);
-        return string_t::npos != pos && pos < args.size() ? args[pos] : variant();
-    };
-
-    return calc(rule, {assist.pr, vr, assist.dm});
-}
-
-variant handler::calc_calls(const node* nd, const calc_assist& assist) {
-    if (!nd->expr.right || !nd->expr.right->is_array()) {
-        return variant();
-    }
-
-    const node_array& wrap = *nd->expr.right->obj.array;
-    switch (nd->expr.oper.code) {
-    case operater::GENERATE:
-        return calc_generate(wrap, assist);
-    case operater::HAS:
-    case operater::PICK:
-    case operater::SELECT:
-    case operater::SORT:
-    case operater::TRANSFORM:
-    case operater::ACCUMULATE:
-        return calc_sequence(nd->expr.oper.code, wrap, assist);
-    case operater::SUMMATE:
-    case operater::PRODUCE:
-        return calc_cumulate(nd->expr.oper.code, wrap, assist);
-    case operater::INTEGRATE:
-        return calc_integrate(wrap, assist);
-    case operater::DOUBLE_INTEGRATE:
-        return calc_integrate2(wrap, assist);
-    case operater::TRIPLE_INTEGRATE:
-        return calc_integrate3(wrap, assist);
-    }
-
-    return variant();
-}
-
-variant handler::calc_generate(const node_array& wrap, const calc_assist& assist) {
-    if (wrap.size() < 2) {
-        return variant();
-    }
-
-    string_t variables0 = wrap[0]->function_variables();
-    variant arg0 = (variables0.empty() ? calc(wrap[0], assist) : variant());
-
-    string_t variables1 = wrap[1]->function_variables();
-    variant arg1 = (variables1.empty() ? calc(wrap[1], assist) : variant());
-    size_t max_size = (arg1.is_valid() ? std::min(static_cast<size_t>(arg1.to_real()), MAX_GENERATE_SIZE) : MAX_GENERATE_SIZE);
-
-    sequence_t res;
-    calc_assist generator_assist = {assist.pr, [&res](char_t) { return res; }, assist.dm};
-    while (res.size() < max_size) {
-        variant item = (variables0.empty() ? arg0 : calc_function(wrap[0], generator_assist));
-        if (!item.is_valid()) {
-            break;
-        }
-
-        if (!variables1.empty()) {
-            variable_replacer vr = [&res, &item, &variables1](char_t variable) { return variables1[0] == variable ? res : item; };
-            if (!calc_function(wrap[1], {assist.pr, vr, assist.dm}).to_boolean()) {
-                break;
-            }
-        }
-
-        res.emplace_back(std::move(item));
-    }
-
-    return res;
-}
-
-variant handler::calc_sequence(operater::operater_code code, const node_array& wrap, const calc_assist& assist) {
-    if (wrap.size() < 2) {
-        return variant();
-    }
-
-    variant arg0 = calc(wrap[0], assist);
-    if (!arg0.is_sequence()) {
-        return variant();
-    }
-
-    string_t variables = wrap[1]->function_variables();
-    variant arg1 = (variables.empty() ? calc(wrap[1], assist) : variant());
-
-    using std::placeholders::_1;
-    const sequence_t& sequence = *arg0.sequence;
-    size_t size = sequence.size();
-    auto sequence_vr = [&sequence](size_t index, const string_t& variables, size_t offset, char_t variable) -> variant {
-        if (offset < variables.size() && variables[offset] == variable) {
-            return sequence[index];
-        }
-
-        ++offset;
-        if (offset < variables.size() && variables[offset] == variable) {
-            return index;
-        }
-
-        return sequence;
-    };
-
-    switch (code) {
-    case operater::HAS: {
-        if (variables.empty()) {
-            return sequence.end() != std::find(sequence.begin(), sequence.end(), arg1);
-        }
-
-        for (size_t index = 0; index < size; ++index) {
-            variable_replacer vr = std::bind(sequence_vr, index, variables, 0, _1);
-            if (calc_function(wrap[1], {assist.pr, vr, assist.dm}).to_boolean()) {
-                return true;
-            }
-        }
-
-        return false;
-    }
-    case operater::PICK: {
-        variant arg2 = (3 <= wrap.size() ? calc(wrap[2], assist) : variant());
-        if (variables.empty()) {
-            real_t real = arg1.to_real();
-            size_t index = static_cast<size_t>(real < 0 ? size + real : real);
-            return index < size ? sequence[index] : arg2;
-        }
-
-        for (size_t index = 0; index < size; ++index) {
-            variable_replacer vr = std::bind(sequence_vr, index, variables, 0, _1);
-            if (calc_function(wrap[1], {assist.pr, vr, assist.dm}).to_boolean()) {
-                return sequence[index];
-            }
-        }
-
-        return arg2;
-    }
-    case operater::SELECT: {
-        sequence_t res;
-        for (size_t index = 0; index < size; ++index) {
-            if (variables.empty()) {
-                if (sequence[index] == arg1) {
-                    res.push_back(arg1);
-                }
-            } else {
-                variable_replacer vr = std::bind(sequence_vr, index, variables, 0, _1);
-                if (calc_function(wrap[1], {assist.pr, vr, assist.dm}).to_boolean()) {
-                    res.push_back(sequence[index]);
-                }
-            }
-        }
-
-        return res;
-    }
-    case operater::SORT: {
-        std::function<bool(const variant& var1, const variant& var2)> pred;
-        if (variables.size() < 2) {
-            operater oper = make_operater(arg1.to_boolean() ? operater::LESS : operater::GREATER);
-            pred = [oper](const variant& var1, const variant& var2) { return operate(var1, oper, var2).to_boolean(); };
-        } else {
-            pred = [&wrap, &assist, &variables](const variant& var1, const variant& var2) {
-                variable_replacer vr = [&var1, &var2, &variables](char_t variable) { return variables[0] == variable ? var1 : var2; };
-                return calc_function(wrap[1], {assist.pr, vr, assist.dm}).to_boolean();
-            };
-        }
-
-        sequence_t res(sequence);
-        std::sort(res.begin(), res.end(), pred);
-        return res;
-    }
-    case operater::TRANSFORM: {
-        sequence_t res(size);
-        for (size_t index = 0; index < size; ++index) {
-            if (variables.empty()) {
-                res[index] = arg1;
-            } else {
-                variable_replacer vr = std::bind(sequence_vr, index, variables, 0, _1);
-                res[index] = calc_function(wrap[1], {assist.pr, vr, assist.dm});
-            }
-        }
-
-        return res;
-    }
-    case operater::ACCUMULATE: {
-        if (wrap.size() < 3) {
-            return variant();
-        }
-
-        variant arg2 = calc(wrap[2], assist);
-        if (!arg2.is_valid() || variables.size() < 2) {
-            return arg2;
-        }
-
-        for (size_t index = 0; index < size; ++index) {
-            variable_replacer vr1 = std::bind(sequence_vr, index, variables, 1, _1);
-            variable_replacer vr = [&arg2, &variables, &vr1](char_t variable) { return variables[0] == variable ? arg2 : vr1(variable); };
-            arg2 = calc_function(wrap[1], {assist.pr, vr, assist.dm});
-        }
-
-        return arg2;
-    }
-    }
-
-    return variant();
-}
-
-handler::bound_t handler::calc_bound(const node* lower_nd, const node* upper_nd, const calc_assist& assist, bool to_zahlen) {
-    bound_t bound = {calc(lower_nd, assist).to_real(), calc(upper_nd, assist).to_real()};
-    if (bound.second < bound.first) {
-        std::swap(bound.first, bound.second);
-    }
-
-    if (to_zahlen) {
-        bound.first = trunc(bound.first);
-        bound.second = trunc(bound.second);
-    }
-
-    return bound;
-}
-
-variant handler::calc_cumulate(operater::operater_code code, const node_array& wrap, const calc_assist& assist) {
-    if (wrap.size() < 3 || wrap[2]->function_variables().empty()) {
-        return variant();
-    }
-
-    variant res;
-    operater oper;
-    switch (code) {
-    case operater::SUMMATE:
-        res = real_t(0);
-        oper = make_operater(operater::PLUS);
-        break;
-    case operater::PRODUCE:
-        res = real_t(1);
-        oper = make_operater(operater::MULTIPLY);
-        break;
-    default:
-        return variant();
-    }
-
-    bound_t bn = calc_bound(wrap[0], wrap[1], assist, true);
-    for (real_t n = bn.first; n <= bn.second; ++n) {
-        res = operate(res, oper, calc_function(wrap[2], {assist.pr, [n](char_t) { return n; }, assist.dm}));
-    }
-
-    return res;
-}
-
-variant handler::calc_integrate(const node_array& wrap, const calc_assist& assist) {
-    if (wrap.size() < 3 || wrap[2]->function_variables().empty()) {
-        return variant();
-    }
-
-    bound_t bx = calc_bound(wrap[0], wrap[1], assist);
-    real_t dx = (bx.second - bx.first) / INTEGRATE_PIECE_SIZE;
-
-    auto integrand = [&wrap, &assist](real_t x) {
-        return calc_function(wrap[2], {assist.pr, [x](char_t) { return x; }, assist.dm}).to_real();
-    };
-
-    real_t res = (integrand(bx.first) + integrand(bx.second)) * 0.5;
-    for (size_t n = 1; n < INTEGRATE_PIECE_SIZE; ++n) {
-        res += integrand(bx.first + dx * n);
-    }
-
-    return res * dx;
-}
-
-variant handler::calc_integrate2(const node_array& wrap, const calc_assist& assist) {
-    if (wrap.size() < 5) {
-        return variant();
-    }
-
-    string_t variables = wrap[4]->function_variables();
-    if (variables.size() < 2) {
-        return variant();
-    }
-
-    bound_t by = calc_bound(wrap[0], wrap[1], assist);
-    real_t dy = (by.second - by.first) / INTEGRATE2_PIECE_SIZE;
-
-    bound_t bx = calc_bound(wrap[2], wrap[3], assist);
-    real_t dx = (bx.second - bx.first) / INTEGRATE2_PIECE_SIZE;
-
-    auto integrand = [&wrap, &assist, &variables](real_t x, real_t y) {
-        variable_replacer vr = [x, y, &variables](char_t variable) { return variables[0] == variable ? x : y; };
-        return calc_function(wrap[4], {assist.pr, vr, assist.dm}).to_real();
-    };
-
-    auto adjust = [](real_t& value, size_t n) {
-        if (0 == n || INTEGRATE2_PIECE_SIZE == n) {
-            value *= 0.5;
-        }
-    };
-
-    real_t res = 0;
-    for (size_t ny = 0; ny <= INTEGRATE2_PIECE_SIZE; ++ny) {
-        real_t y = by.first + dy * ny;
-        for (size_t nx = 0; nx <= INTEGRATE2_PIECE_SIZE; ++nx) {
-            real_t value = integrand(bx.first + dx * nx, y);
-            adjust(value, nx);
-            adjust(value, ny);
-            res += value;
-        }
-    }
-
-    return res * dx * dy;
-}
-
-variant handler::calc_integrate3(const node_array& wrap, const calc_assist& assist) {
-    if (wrap.size() < 7) {
-        return variant();
-    }
-
-    string_t variables = wrap[6]->function_variables();
-    if (variables.size() < 3) {
-        return variant();
-    }
-
-    bound_t bz = calc_bound(wrap[0], wrap[1], assist);
-    real_t dz = (bz.second - bz.first) / INTEGRATE3_PIECE_SIZE;
-
-    bound_t by = calc_bound(wrap[2], wrap[3], assist);
-    real_t dy = (by.second - by.first) / INTEGRATE3_PIECE_SIZE;
-
-    bound_t bx = calc_bound(wrap[4], wrap[5], assist);
-    real_t dx = (bx.second - bx.first) / INTEGRATE3_PIECE_SIZE;
-
-    auto integrand = [&wrap, &assist, &variables](real_t x, real_t y, real_t z) {
-        variable_replacer vr = [x, y, z, &variables](char_t variable) {
-            return variables[0] == variable ? x : (variables[1] == variable ? y : z);
-        };
-        return calc_function(wrap[6], {assist.pr, vr, assist.dm}).to_real();
-    };
-
-    auto adjust = [](real_t& value, size_t n) {
-        if (0 == n || INTEGRATE3_PIECE_SIZE == n) {
-            value *= 0.5;
-        }
-    };
-
-    real_t res = 0;
-    for (size_t nz = 0; nz <= INTEGRATE3_PIECE_SIZE; ++nz) {
-        real_t z = bz.first + dz * nz;
-        for (size_t ny = 0; ny <= INTEGRATE3_PIECE_SIZE; ++ny) {
-            real_t y = by.first + dy * ny;
-            for (size_t nx = 0; nx <= INTEGRATE3_PIECE_SIZE; ++nx) {
-                real_t value = integrand(bx.first + dx * nx, y, z);
-                adjust(value, nx);
-                adjust(value, ny);
-                adjust(value, nz);
-                res += value;
-            }
-        }
-    }
-
-    return res * dx * dy * dz;
-}
-
 }
@@ -30,73 +30,129 @@
 
 namespace expr {
 
+template<class value_t>
+class lexicon;
+
+class library;
+using library_ptr = std::shared_ptr<const library>;
+
+class program;
+using program_ptr = std::shared_ptr<const program>;
+
+// immutable once parsed, copies share the tree and the program
 class handler {
 public:
     using param_replacer = std::function<variant(const string_t& param)>;
     using variable_replacer = std::function<variant(char_t variable)>;
-    using bound_t = std::pair<real_t, real_t>;
+    // values or reals bind the first count params of params()
     struct calc_assist {
         param_replacer pr;
         variable_replacer vr;
-        mutable define_map_ptr dm;
+        const variant* values;
+        const real_t* reals;
+        size_t count;
+
+        calc_assist(param_replacer pr = nullptr, variable_replacer vr = nullptr)
+            : pr(std::move(pr)), vr(std::move(vr)), values(nullptr), reals(nullptr), count(0) {}
+    };
+    // each level adds to the ones before
+    enum optimize_level : uint8_t {
+        FOLD,       // literal parts folded
+        REDUCE,     // costly forms made cheap, repeats merged
+        TYPED,      // routines of known types run on plain reals and complexes
+        NATIVE      // machine code for the root and the items that only use reals, x86-64 only
     };
 
 public:
-    explicit handler(const string_t& expr);
-    handler(const handler& other) = delete;
+    handler() = default;
+    // local defines take precedence over lib
+    explicit handler(const string_t& expr, library_ptr lib = nullptr);
+    explicit handler(const std::string& expr, library_ptr lib = nullptr);
+    handler(const char_t* expr, size_t size, library_ptr lib = nullptr);
+    handler(const char* expr, size_t size, library_ptr lib = nullptr);
+    handler(const handler& other);
     handler(handler&& other) noexcept;
     ~handler();
 
-    handler& operator=(const handler& other) = delete;
+    handler& operator=(const handler& other);
     handler& operator=(handler&& other) noexcept;
 
 public:
+    // failed_pos counts bytes for utf-8 sources
     bool is_valid(size_t* failed_pos = nullptr) const;
     string_t expr() const;
+    // exact form of expr(), equal keys mean equal expressions
+    string_t key() const;
     string_t latex() const;
     string_t tree(size_t indent = 0) const;
+    // reentrant
     variant calc(const calc_assist& assist = calc_assist()) const;
+    string_array params() const;
+    // built on first use
+    program_ptr compile() const;
+    // not reentrant, copies keep the level
+    void optimize(optimize_level level);
+    optimize_level optimization() const;
+    // empty for invalid handlers
+    std::string save() const;
+    static handler load(const void* blob, size_t size, library_ptr lib = nullptr);
 
 private:
+    friend class editor;
+    friend class library;
+    struct item_span {
+        node* nd;
+        size_t index;
+        size_t begin;
+        size_t end;
+    };
+    using span_list = std::vector<item_span>;
+
+    explicit handler(node* root);
+
+    void parse();
+    define_map_ptr resolve_defines(const node* defines) const;
     char_t get_char(bool skip_space = true);
+    void unget_char();
     char_t peek_char();
     bool try_match(const string_t& text);
+    template<class value_t>
+    bool try_match(const lexicon<value_t>& lex, value_t& value);
     bool atom_ended();
     bool finished();
 
     node* parse_defines();
-    node* parse_atom();
+    node* parse_atom(const define_map_ptr& dm);
+    node* parse_array();
+    node* parse_frames(bool array, bool validate, const define_map_ptr& dm);
     node* parse_operater(operater::operater_kind kind);
     node* parse_function();
     node* parse_object();
     node* parse_constant();
     node* parse_numeric();
+    bool scan_numeric(real_t& num, bool& is_imag);
+    bool scan_packed(real_t& num);
     node* parse_string();
     node* parse_param();
     node* parse_variable();
-    node* parse_array(bool boundary);
 
-    static string_t text(const node* nd);
-    static string_t expr(const node* nd);
+    static string_t text(const node* nd, bool exact = false);
+    static string_t expr(const node* nd, bool exact = false);
     static string_t latex(const node* nd);
     static string_t tree(const node* nd, size_t indent);
 
-    static variant calc(const node* nd, const calc_assist& assist);
-    static variant calc_object(const node* nd, const calc_assist& assist);
-    static variant calc_function(const node* nd, const calc_assist& assist);
-    static variant calc_calls(const node* nd, const calc_assist& assist);
-    static variant calc_generate(const node_array& wrap, const calc_assist& assist);
-    static variant calc_sequence(operater::operater_code code, const node_array& wrap, const calc_assist& assist);
-    static bound_t calc_bound(const node* lower_nd, const node* upper_nd, const calc_assist& assist, bool to_zahlen = false);
-    static variant calc_cumulate(operater::operater_code code, const node_array& wrap, const calc_assist& assist);
-    static variant calc_integrate(const node_array& wrap, const calc_assist& assist);
-    static variant calc_integrate2(const node_array& wrap, const calc_assist& assist);
-    static variant calc_integrate3(const node_array& wrap, const calc_assist& assist);
-
 private:
-    string_t m_expr;
+    const char_t* m_wide = nullptr;
+    const char* m_utf8 = nullptr;
+    size_t m_size = 0;
     size_t m_pos = 0;
+    size_t m_prev = 0;
     node* m_root = nullptr;
+    arena_ptr m_arena;
+    library_ptr m_library;
+    span_list* m_spans = nullptr;
+    optimize_level m_level = FOLD;
+    mutable program_ptr m_program;
 };
 
 }
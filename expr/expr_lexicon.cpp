@@ -0,0 +1,65 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_lexicon.h"
+
+#define EXTRA_EXPR_NODE
+#include "extradefs.h"
+
+namespace expr {
+
+static lexicon<operater::operater_code> build_operater_lexicon(operater::operater_kind kind) {
+    lexicon<operater::operater_code> lex;
+    for (const extra_operater_code& record : EXTRA_OPERATER_CODE) {
+        if (kind == record.kind) {
+            lex.insert(record.name, record.key);
+            lex.insert(record.alias, record.key);
+        }
+    }
+
+    return lex;
+}
+
+static lexicon<object::object_constant> build_constant_lexicon() {
+    lexicon<object::object_constant> lex;
+    for (const extra_object_constant& record : EXTRA_OBJECT_CONSTANT) {
+        lex.insert(record.name, record.key);
+        lex.insert(record.alias, record.key);
+    }
+
+    return lex;
+}
+
+const lexicon<operater::operater_code>& operater_lexicon(operater::operater_kind kind) {
+    static const lexicon<operater::operater_code> unary_lexicon = build_operater_lexicon(operater::UNARY);
+    static const lexicon<operater::operater_code> binary_lexicon = build_operater_lexicon(operater::BINARY);
+    return operater::UNARY == kind ? unary_lexicon : binary_lexicon;
+}
+
+const lexicon<object::object_constant>& constant_lexicon() {
+    static const lexicon<object::object_constant> lex = build_constant_lexicon();
+    return lex;
+}
+
+}
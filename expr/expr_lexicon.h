@@ -0,0 +1,104 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EXPR_LEXICON_H
+#define EXPR_LEXICON_H
+
+#include <algorithm>
+#include "expr_node.h"
+
+namespace expr {
+
+// trie of words, walked for the longest match
+template<class value_t>
+class lexicon {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    lexicon() : m_states(1) {}
+
+    void insert(const string_t& word, value_t value) {
+        if (word.empty()) {
+            return;
+        }
+
+        size_t current = 0;
+        for (char_t ch : word) {
+            auto& edges = m_states[current].edges;
+            auto iter = std::lower_bound(edges.begin(), edges.end(), ch, edge_less);
+            if (edges.end() != iter && iter->first == ch) {
+                current = iter->second;
+            } else {
+                size_t created = m_states.size();
+                edges.insert(iter, std::make_pair(ch, created));
+                m_states.emplace_back();
+                current = created;
+            }
+        }
+
+        m_states[current].accepted = true;
+        m_states[current].value = value;
+    }
+
+    size_t next(size_t current, char_t ch) const {
+        const auto& edges = m_states[current].edges;
+        auto iter = std::lower_bound(edges.begin(), edges.end(), ch, edge_less);
+        return edges.end() != iter && iter->first == ch ? iter->second : npos;
+    }
+
+    bool accept(size_t current, value_t& value) const {
+        const state& st = m_states[current];
+        if (st.accepted) {
+            value = st.value;
+        }
+
+        return st.accepted;
+    }
+
+private:
+    using edge = std::pair<char_t, size_t>;
+
+    struct state {
+        std::vector<edge> edges;
+        bool accepted = false;
+        value_t value = value_t();
+    };
+
+    static bool edge_less(const edge& e, char_t ch) {
+        return e.first < ch;
+    }
+
+private:
+    std::vector<state> m_states;
+};
+
+template<class value_t>
+const size_t lexicon<value_t>::npos;
+
+const lexicon<operater::operater_code>& operater_lexicon(operater::operater_kind kind);
+const lexicon<object::object_constant>& constant_lexicon();
+
+}
+
+#endif
@@ -0,0 +1,107 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_library.h"
+#include "expr_link.h"
+
+namespace expr {
+
+library::library(const string_t& defines) {
+    arena::scope scope(&m_arena);
+    handler hdl;
+    hdl.m_wide = defines.data();
+    hdl.m_size = defines.size();
+    parse(hdl);
+}
+
+library::library(const std::string& defines) {
+    arena::scope scope(&m_arena);
+    handler hdl;
+    hdl.m_utf8 = defines.data();
+    hdl.m_size = defines.size();
+    parse(hdl);
+}
+
+library::~library() {
+    delete m_defines;
+}
+
+bool library::is_valid(size_t* failed_pos) const {
+    if (m_dm) {
+        return true;
+    }
+
+    if (failed_pos) {
+        *failed_pos = m_failed_pos;
+    }
+
+    return false;
+}
+
+size_t library::size() const {
+    return m_dm ? m_dm->size() : 0;
+}
+
+string_t library::expr() const {
+    string_t str = handler::expr(m_defines);
+    if (!str.empty()) {
+        str.front() = STR('{');
+        str.back() = STR('}');
+    }
+
+    return str;
+}
+
+const define_map_ptr& library::define_map() const {
+    return m_dm;
+}
+
+library_ptr library::make(const string_t& defines) {
+    return std::make_shared<library>(defines);
+}
+
+library_ptr library::make(const std::string& defines) {
+    return std::make_shared<library>(defines);
+}
+
+void library::parse(handler& hdl) {
+    node* defines = hdl.parse_defines();
+    if (!defines) {
+        hdl.m_pos = 0;
+        defines = hdl.parse_array();
+    }
+
+    define_map_ptr dm = defines && hdl.finished() ? node::make_define_map(defines) : nullptr;
+    if (!dm) {
+        m_failed_pos = hdl.m_pos;
+        delete defines;
+        return;
+    }
+
+    bind_node(defines, dm);
+    m_defines = defines;
+    m_dm = dm;
+}
+
+}
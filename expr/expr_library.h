@@ -0,0 +1,63 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EXPR_LIBRARY_H
+#define EXPR_LIBRARY_H
+
+#include "expr_handler.h"
+
+namespace expr {
+
+// read-only defines shared by handlers on any thread
+class library {
+public:
+    explicit library(const string_t& defines);
+    explicit library(const std::string& defines);
+    library(const library& other) = delete;
+    ~library();
+
+    library& operator=(const library& other) = delete;
+
+public:
+    bool is_valid(size_t* failed_pos = nullptr) const;
+    size_t size() const;
+    string_t expr() const;
+    const define_map_ptr& define_map() const;
+
+    static library_ptr make(const string_t& defines);
+    static library_ptr make(const std::string& defines);
+
+private:
+    void parse(handler& hdl);
+
+private:
+    arena m_arena;
+    node* m_defines = nullptr;
+    define_map_ptr m_dm;
+    size_t m_failed_pos = 0;
+};
+
+}
+
+#endif
@@ -30,22 +30,36 @@
 namespace expr {
 
 operater make_operater(operater::operater_code code) {
+    const extra_operater_code& record = EXTRA_OPERATER_CODE[code];
     operater oper;
-    oper.type = static_cast<decltype(oper.type)>(EXTRA_OPERATER_CODE.integer(code, operater::TYPE));
-    oper.kind = static_cast<decltype(oper.kind)>(EXTRA_OPERATER_CODE.integer(code, operater::KIND));
-    oper.priority = EXTRA_OPERATER_CODE.integer(code, operater::PRIORITY);
-    oper.postpose = EXTRA_OPERATER_CODE.integer(code, operater::POSTPOSE);
+    oper.type = static_cast<decltype(oper.type)>(record.type);
+    oper.kind = static_cast<decltype(oper.kind)>(record.kind);
+    oper.priority = record.priority;
+    oper.postpose = 0 != record.postpose;
     oper.code = code;
     return oper;
 }
 
+const operater& operater_of(operater::operater_code code) {
+    static const std::vector<operater> table = [] {
+        std::vector<operater> opers;
+        for (size_t code = 0; code < std::extent<decltype(EXTRA_OPERATER_CODE)>::value; ++code) {
+            opers.push_back(make_operater(static_cast<operater::operater_code>(code)));
+        }
+        return opers;
+    }();
+
+    return table[code];
+}
+
 operater make_function(const string_t& function) {
     operater oper;
     oper.type = operater::FUNCTION;
     oper.kind = operater::UNARY;
     oper.priority = 1;
     oper.postpose = false;
-    oper.function = new string_t(function);
+    oper.function = create_object<function_call>();
+    oper.function->name = intern(function);
     return oper;
 }
 
@@ -73,14 +87,14 @@ object make_imaginary(real_t imaginary) {
 object make_string(const string_t& string) {
     object obj;
     obj.type = object::STRING;
-    obj.string = new string_t(string);
+    obj.string = create_object<string_t>(string);
     return obj;
 }
 
 object make_param(const string_t& param) {
     object obj;
     obj.type = object::PARAM;
-    obj.param = new string_t(param);
+    obj.param = intern(param);
     return obj;
 }
 
@@ -94,7 +108,14 @@ object make_variable(char_t variable) {
 object make_array(const node_array& array) {
     object obj;
     obj.type = object::ARRAY;
-    obj.array = new node_array(array);
+    obj.array = create_object<node_array>(array);
+    return obj;
+}
+
+object make_real_array(real_array reals) {
+    object obj;
+    obj.type = object::REAL_ARRAY;
+    obj.reals = create_object<real_array>(std::move(reals));
     return obj;
 }
 
@@ -268,11 +289,12 @@ bool test_link(const node* parent, node::node_side side, const node* child, defi
     case operater::ARITHMETIC:
         return child->is_value_result();
     case operater::EVALUATION:
+        return child->is_array() || child->is_real_array();
     case operater::INVOCATION:
     case operater::LARGESCALE:
         return child->is_array();
     case operater::FUNCTION:
-        return child->is_array() && dm && dm->end() != dm->find(*parent->expr.oper.function);
+        return child->is_array() && dm && dm->lookup(parent->expr.oper.function->name);
     }
 
     return false;
@@ -307,4 +329,50 @@ bool test_node(const node* nd, define_map_ptr dm) {
     return false;
 }
 
+bool bind_function(node* nd, const define_map_ptr& dm) {
+    if (!nd || !nd->is_function()) {
+        return false;
+    }
+
+    function_call* call = nd->expr.oper.function;
+    const define_table::mapped_type* define = dm ? dm->lookup(call->name) : nullptr;
+    if (!define) {
+        call->variables.clear();
+        call->rule = nullptr;
+        return false;
+    }
+
+    call->variables = define->first;
+    call->rule = define->second;
+    return true;
+}
+
+void bind_node(node* nd, const define_map_ptr& dm) {
+    node_array pending;
+    if (nd) {
+        pending.push_back(nd);
+    }
+
+    while (!pending.empty()) {
+        nd = pending.back();
+        pending.pop_back();
+
+        if (nd->defines) {
+            pending.push_back(nd->defines);
+        }
+
+        if (nd->is_array()) {
+            pending.insert(pending.end(), nd->obj.array->begin(), nd->obj.array->end());
+        } else if (nd->is_expr()) {
+            bind_function(nd, dm);
+            if (nd->expr.left) {
+                pending.push_back(nd->expr.left);
+            }
+            if (nd->expr.right) {
+                pending.push_back(nd->expr.right);
+            }
+        }
+    }
+}
+
 }
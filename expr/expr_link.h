@@ -30,6 +30,7 @@
 namespace expr {
 
 operater make_operater(operater::operater_code code);
+const operater& operater_of(operater::operater_code code);
 operater make_function(const string_t& function);
 object make_boolean(bool boolean);
 object make_real(real_t real);
@@ -38,6 +39,7 @@ object make_string(const string_t& string);
 object make_param(const string_t& param);
 object make_variable(char_t variable);
 object make_array(const node_array& array);
+object make_real_array(real_array reals);
 node* make_node(const object& obj);
 node* make_node(const operater& oper);
 
@@ -46,6 +48,8 @@ bool insert_node(node*& root, node*& semi, node*& pending, node*& current);
 bool detach_node(node* nd);
 bool test_link(const node* parent, node::node_side side, const node* child, define_map_ptr dm = nullptr);
 bool test_node(const node* nd, define_map_ptr dm = nullptr);
+bool bind_function(node* nd, const define_map_ptr& dm);
+void bind_node(node* nd, const define_map_ptr& dm);
 
 }
 
@@ -0,0 +1,567 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_native.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "expr_link.h"
+#include "expr_operate.h"
+#include "expr_program.h"
+
+#if defined(K_LINUX)
+#include <sys/mman.h>
+#endif
+
+namespace expr {
+
+const size_t MAX_NATIVE_SLOTS   = 1024;
+const size_t MAX_NATIVE_DEPTH   = 64;
+
+static const double NOT_REAL = std::numeric_limits<double>::quiet_NaN();
+
+using helper_t = double (*)(double left, double right, const operater* oper);
+
+static double operate_helper(double left, double right, const operater* oper) {
+    if (std::isnan(left) || std::isnan(right)) {
+        return NOT_REAL;
+    }
+
+    variant res = operate(left, *oper, right);
+    return res.is_real() ? res.real : (res.is_boolean() ? double(res.boolean) : NOT_REAL);
+}
+
+static double sin_helper(double left, double right, const operater* oper) {
+    return sin(right);
+}
+
+static double cos_helper(double left, double right, const operater* oper) {
+    return cos(right);
+}
+
+static double exp_helper(double left, double right, const operater* oper) {
+    return exp(right);
+}
+
+static double ln_helper(double left, double right, const operater* oper) {
+    return 0 <= right ? log(right) : NOT_REAL;
+}
+
+static double pow_helper(double left, double right, const operater* oper) {
+    return 0 <= left && !std::isnan(right) ? pow(left, right) : NOT_REAL;
+}
+
+class assembler {
+public:
+    enum reg_t : uint8_t {
+        RAX = 0,
+        RSP = 4,
+        RBP = 5,
+        RBX = 3,
+        RSI = 6,
+        RDI = 7,
+        R12 = 12
+    };
+
+    enum sse_t : uint8_t {
+        MOVSD_LOAD  = 0x10,
+        MOVSD_STORE = 0x11,
+        MOVAPD      = 0x28,
+        SQRTSD      = 0x51,
+        ANDPD       = 0x54,
+        ORPD        = 0x56,
+        XORPD       = 0x57,
+        ADDSD       = 0x58,
+        MULSD       = 0x59,
+        SUBSD       = 0x5c,
+        DIVSD       = 0x5e,
+        CMPSD       = 0xc2
+    };
+
+    enum predicate_t : uint8_t {
+        EQ      = 0,
+        LT      = 1,
+        LE      = 2,
+        UNORD   = 3,
+        NEQ     = 4,
+        NLT     = 5,
+        NLE     = 6
+    };
+
+    void sse(sse_t op, uint8_t xmm, reg_t base, int32_t disp) {
+        emit(prefix_of(op));
+        if (8 <= base) {
+            emit(0x41);
+        }
+        emit(0x0f, op);
+        emit(0x80 | (xmm << 3) | (base & 7));
+        if (RSP == (base & 7)) {
+            emit(0x24);
+        }
+        emit_bytes(&disp, sizeof(disp));
+    }
+
+    void sse(sse_t op, uint8_t dst, uint8_t src) {
+        emit(prefix_of(op));
+        emit(0x0f, op);
+        emit(0xc0 | (dst << 3) | src);
+    }
+
+    void cmpsd(uint8_t dst, uint8_t src, predicate_t predicate) {
+        sse(CMPSD, dst, src);
+        emit(predicate);
+    }
+
+    void load_constant(uint8_t xmm, double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        mov(RAX, bits);
+        // movq xmm, rax
+        emit(0x66, 0x48);
+        emit(0x0f, 0x6e);
+        emit(0xc0 | (xmm << 3));
+    }
+
+    void mov(reg_t dst, uint64_t imm) {
+        emit(0x48, 0xb8 | dst);
+        emit_bytes(&imm, sizeof(imm));
+    }
+
+    void call(const void* function) {
+        mov(RAX, reinterpret_cast<uint64_t>(function));
+        emit(0xff, 0xd0);
+    }
+
+    // vars in rbx, params in r12
+    void prologue() {
+        emit(0x55);
+        emit(0x48, 0x89);
+        emit(0xe5);
+        emit(0x53);
+        emit(0x41, 0x54);
+        emit(0x48, 0x81);
+        emit(0xec);
+        m_frame = m_bytes.size();
+        emit_bytes(&m_frame, sizeof(uint32_t));
+        emit(0x48, 0x89);
+        emit(0xfb);
+        emit(0x49, 0x89);
+        emit(0xf4);
+    }
+
+    void epilogue(uint32_t frame) {
+        memcpy(&m_bytes[m_frame], &frame, sizeof(frame));
+        emit(0x48, 0x81);
+        emit(0xc4);
+        emit_bytes(&frame, sizeof(frame));
+        emit(0x41, 0x5c);
+        emit(0x5b);
+        emit(0x5d);
+        emit(0xc3);
+    }
+
+    const std::vector<uint8_t>& bytes() const {
+        return m_bytes;
+    }
+
+private:
+    static uint8_t prefix_of(sse_t op) {
+        return MOVAPD == op || ANDPD == op || ORPD == op || XORPD == op ? 0x66 : 0xf2;
+    }
+
+    void emit(uint8_t byte) {
+        m_bytes.push_back(byte);
+    }
+
+    void emit(uint8_t byte1, uint8_t byte2) {
+        m_bytes.push_back(byte1);
+        m_bytes.push_back(byte2);
+    }
+
+    void emit_bytes(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_bytes.insert(m_bytes.end(), bytes, bytes + size);
+    }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    size_t m_frame = 0;
+};
+
+class native::builder {
+public:
+    struct value {
+        uint32_t slot;
+        bool boolean;
+    };
+
+    builder(const program& pg, const string_t& variables) : m_program(pg), m_variables(variables) {
+        m_code.prologue();
+    }
+
+    bool lower(uint32_t index, const std::vector<value>& args, value& result);
+
+    uint32_t frame_size() const {
+        return (m_slots * 8 + 15) & ~15u;
+    }
+
+    assembler& code() {
+        return m_code;
+    }
+
+    const std::vector<uint32_t>& params() const {
+        return m_params;
+    }
+
+private:
+    bool lower_operate(const program::instruction& ins, const std::vector<value>& values, value& result);
+    bool new_slot(value& result, bool boolean);
+
+    int32_t offset(const value& val) const {
+        return static_cast<int32_t>(val.slot * 8);
+    }
+
+    void store(value& result) {
+        m_code.sse(assembler::MOVSD_STORE, 0, assembler::RSP, offset(result));
+    }
+
+    void load(uint8_t xmm, const value& val) {
+        m_code.sse(assembler::MOVSD_LOAD, xmm, assembler::RSP, offset(val));
+    }
+
+private:
+    const program& m_program;
+    const string_t& m_variables;
+    assembler m_code;
+    uint32_t m_slots = 0;
+    std::vector<uint32_t> m_params;
+    std::vector<uint32_t> m_calls;
+};
+
+bool native::builder::new_slot(value& result, bool boolean) {
+    if (MAX_NATIVE_SLOTS <= m_slots) {
+        return false;
+    }
+
+    result = {m_slots++, boolean};
+    return true;
+}
+
+bool native::builder::lower(uint32_t index, const std::vector<value>& args, value& result) {
+    using instruction = program::instruction;
+    const program::routine& rt = m_program.m_routines[index];
+    if (rt.begin == rt.end || MAX_NATIVE_DEPTH <= m_calls.size() ||
+        m_calls.end() != std::find(m_calls.begin(), m_calls.end(), index)) {
+        return false;
+    }
+
+    m_calls.push_back(index);
+    std::vector<value> values(rt.end - rt.begin);
+    for (uint32_t pc = rt.begin; pc < rt.end; ++pc) {
+        const instruction& ins = m_program.m_code[pc];
+        value& val = values[pc - rt.begin];
+        switch (ins.code) {
+        case instruction::CONSTANT: {
+            const variant& constant = m_program.m_constants[ins.left];
+            if (!(constant.is_real() || constant.is_boolean()) || !new_slot(val, constant.is_boolean())) {
+                return false;
+            }
+            m_code.load_constant(0, constant.to_real());
+            store(val);
+            break;
+        }
+        case instruction::PARAM: {
+            auto it = std::find(m_params.begin(), m_params.end(), ins.left);
+            size_t position = it - m_params.begin();
+            if (m_params.end() == it) {
+                m_params.push_back(ins.left);
+            }
+            if (!new_slot(val, false)) {
+                return false;
+            }
+            m_code.sse(assembler::MOVSD_LOAD, 0, assembler::R12, static_cast<int32_t>(position * 8));
+            store(val);
+            break;
+        }
+        case instruction::VARIABLE: {
+            if (m_variables.empty() || !new_slot(val, false)) {
+                return false;
+            }
+            size_t position = std::min(m_variables.find(static_cast<char_t>(ins.left)), m_variables.size() - 1);
+            m_code.sse(assembler::MOVSD_LOAD, 0, assembler::RBX, static_cast<int32_t>(position * 8));
+            store(val);
+            break;
+        }
+        case instruction::LOCAL:
+            if (m_variables.size() <= ins.left || !new_slot(val, false)) {
+                return false;
+            }
+            m_code.sse(assembler::MOVSD_LOAD, 0, assembler::RBX, static_cast<int32_t>(ins.left * 8));
+            store(val);
+            break;
+        case instruction::ARGUMENT:
+            if (args.size() <= ins.left) {
+                return false;
+            }
+            val = args[ins.left];
+            break;
+        case instruction::NUMBER:
+            if (values[ins.right].boolean) {
+                return false;
+            }
+            val = values[ins.right];
+            break;
+        case instruction::CALL: {
+            const uint32_t* operands = &m_program.m_operands[ins.left];
+            std::vector<value> call_args;
+            for (uint32_t n = 1; n <= ins.right; ++n) {
+                call_args.push_back(values[(operands[n] & ~program::SHARED)]);
+            }
+            if (!lower(operands[0], call_args, val)) {
+                return false;
+            }
+            break;
+        }
+        default:
+            if (!ins.is_operate() || !lower_operate(ins, values, val)) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    m_calls.pop_back();
+    result = values.back();
+    return true;
+}
+
+bool native::builder::lower_operate(const program::instruction& ins, const std::vector<value>& values, value& result) {
+    const operater& oper = operater_of(static_cast<operater::operater_code>(ins.oper));
+    bool has_left = program::NONE != ins.left;
+    bool has_right = program::NONE != ins.right;
+    bool shaped = operater::BINARY == oper.kind ? has_left && has_right : (oper.postpose ? has_left && !has_right : !has_left && has_right);
+    if (!shaped) {
+        return false;
+    }
+
+    value left = has_left ? values[ins.left] : value{0, false};
+    value right = has_right ? values[ins.right] : value{0, false};
+    bool reals = !(has_left && left.boolean) && !(has_right && right.boolean);
+    switch (oper.type) {
+    case operater::LOGIC:
+        if (operater::AND != oper.code && operater::OR != oper.code) {
+            return false;
+        }
+        break;
+    case operater::RELATION:
+    case operater::ARITHMETIC:
+        if (!reals) {
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    if (!new_slot(result, operater::ARITHMETIC != oper.type)) {
+        return false;
+    }
+
+    switch (oper.code) {
+    case operater::PLUS:
+    case operater::MINUS:
+    case operater::MULTIPLY: {
+        static const assembler::sse_t ops[] = {assembler::ADDSD, assembler::SUBSD, assembler::MULSD};
+        load(0, left);
+        m_code.sse(ops[oper.code - operater::PLUS], 0, assembler::RSP, offset(right));
+        break;
+    }
+    case operater::DIVIDE:
+        load(0, left);
+        load(1, right);
+        m_code.sse(assembler::XORPD, 2, 2);
+        m_code.cmpsd(2, 1, assembler::EQ);
+        m_code.sse(assembler::DIVSD, 0, 1);
+        m_code.sse(assembler::ORPD, 0, 2);
+        break;
+    case operater::NEGATIVE:
+        load(0, right);
+        m_code.load_constant(1, -0.0);
+        m_code.sse(assembler::XORPD, 0, 1);
+        break;
+    case operater::ABS: {
+        double mask;
+        uint64_t bits = 0x7fffffffffffffffull;
+        memcpy(&mask, &bits, sizeof(mask));
+        load(0, right);
+        m_code.load_constant(1, mask);
+        m_code.sse(assembler::ANDPD, 0, 1);
+        break;
+    }
+    case operater::SQRT:
+        m_code.sse(assembler::SQRTSD, 0, assembler::RSP, offset(right));
+        break;
+    case operater::EQUAL:
+    case operater::NOT_EQUAL:
+    case operater::LESS:
+    case operater::LESS_EQUAL:
+    case operater::GREATER:
+    case operater::GREATER_EQUAL:
+    case operater::AND:
+    case operater::OR: {
+        load(0, left);
+        load(1, right);
+        m_code.sse(assembler::MOVAPD, 3, 0);
+        m_code.cmpsd(3, 1, assembler::UNORD);
+        switch (oper.code) {
+        case operater::EQUAL:
+            m_code.cmpsd(0, 1, assembler::EQ);
+            break;
+        case operater::NOT_EQUAL:
+            m_code.cmpsd(0, 1, assembler::NEQ);
+            break;
+        case operater::LESS:
+            m_code.cmpsd(0, 1, assembler::LT);
+            break;
+        case operater::LESS_EQUAL:
+            m_code.cmpsd(0, 1, assembler::LE);
+            break;
+        case operater::GREATER:
+            m_code.cmpsd(0, 1, assembler::NLE);
+            break;
+        case operater::GREATER_EQUAL:
+            m_code.cmpsd(0, 1, assembler::NLT);
+            break;
+        default:
+            m_code.sse(assembler::XORPD, 2, 2);
+            m_code.cmpsd(0, 2, assembler::NEQ);
+            m_code.cmpsd(1, 2, assembler::NEQ);
+            m_code.sse(operater::AND == oper.code ? assembler::ANDPD : assembler::ORPD, 0, 1);
+            break;
+        }
+        m_code.load_constant(2, 1.0);
+        m_code.sse(assembler::ANDPD, 0, 2);
+        m_code.sse(assembler::ORPD, 0, 3);
+        break;
+    }
+    default: {
+        helper_t helper = operate_helper;
+        switch (oper.code) {
+        case operater::SIN:
+            helper = sin_helper;
+            break;
+        case operater::COS:
+            helper = cos_helper;
+            break;
+        case operater::EXP:
+            helper = exp_helper;
+            break;
+        case operater::LN:
+            helper = ln_helper;
+            break;
+        case operater::POW:
+            helper = pow_helper;
+            break;
+        }
+        has_left ? load(0, left) : m_code.load_constant(0, 0);
+        has_right ? load(1, right) : m_code.load_constant(1, 0);
+        m_code.mov(assembler::RDI, reinterpret_cast<uint64_t>(&oper));
+        m_code.call(reinterpret_cast<const void*>(helper));
+        break;
+    }
+    }
+
+    store(result);
+    return true;
+}
+
+native::~native() {
+#if defined(K_LINUX)
+    if (m_code) {
+        munmap(m_code, m_size);
+    }
+#endif
+}
+
+native_ptr native::compile(const program& pg, uint32_t routine, const string_t& variables) {
+#if defined(K_LINUX) && defined(__x86_64__)
+    if (pg.m_routines.size() <= routine) {
+        return nullptr;
+    }
+
+    builder bd(pg, variables);
+    builder::value result;
+    if (!bd.lower(routine, {}, result)) {
+        return nullptr;
+    }
+
+    assembler& code = bd.code();
+    code.sse(assembler::MOVSD_LOAD, 0, assembler::RSP, static_cast<int32_t>(result.slot * 8));
+    code.epilogue(bd.frame_size());
+    const std::vector<uint8_t>& bytes = code.bytes();
+
+    void* mapping = mmap(nullptr, bytes.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == mapping) {
+        return nullptr;
+    }
+    memcpy(mapping, bytes.data(), bytes.size());
+    if (0 != mprotect(mapping, bytes.size(), PROT_READ | PROT_EXEC)) {
+        munmap(mapping, bytes.size());
+        return nullptr;
+    }
+
+    std::shared_ptr<native> nt(new native());
+    nt->m_code = mapping;
+    nt->m_size = bytes.size();
+    nt->m_variables = variables;
+    nt->m_params = bd.params();
+    nt->m_boolean = result.boolean;
+    return nt;
+#else
+    return nullptr;
+#endif
+}
+
+native::function_t native::function() const {
+    return reinterpret_cast<function_t>(m_code);
+}
+
+const string_t& native::variables() const {
+    return m_variables;
+}
+
+const std::vector<uint32_t>& native::params() const {
+    return m_params;
+}
+
+bool native::boolean() const {
+    return m_boolean;
+}
+
+variant native::value(double result) const {
+    return m_boolean ? variant(0 != result) : variant(result);
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EXPR_NATIVE_H
+#define EXPR_NATIVE_H
+
+#include <cstdint>
+#include <memory>
+#include "expr_variant.h"
+
+namespace expr {
+
+class program;
+class native;
+using native_ptr = std::shared_ptr<const native>;
+
+// x86-64 System V only, a NaN result falls back to the interpreter
+class native {
+public:
+    using function_t = double (*)(const double* vars, const double* params);
+
+    native(const native& other) = delete;
+    ~native();
+
+    native& operator=(const native& other) = delete;
+
+public:
+    // nullptr for routines the code does not cover
+    static native_ptr compile(const program& pg, uint32_t routine, const string_t& variables);
+
+    function_t function() const;
+    const string_t& variables() const;
+    const std::vector<uint32_t>& params() const;
+    bool boolean() const;
+    variant value(double result) const;
+
+private:
+    class builder;
+
+    native() = default;
+
+private:
+    void* m_code = nullptr;
+    size_t m_size = 0;
+    string_t m_variables;
+    std::vector<uint32_t> m_params;
+    bool m_boolean = false;
+};
+
+}
+
+#endif
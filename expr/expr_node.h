@@ -27,12 +27,37 @@
 
 #include <map>
 #include <memory>
+#include "expr_arena.h"
+#include "expr_symbol.h"
 #include "expr_variant.h"
 
 namespace expr {
 
 using node_array = std::vector<struct node*>;
-using define_map_ptr = std::shared_ptr<std::map<string_t, std::pair<string_t, const struct node*>>>;
+using real_array = std::vector<real_t>;
+
+// names missing here are looked up in the fallback
+struct define_table : std::map<symbol_t, std::pair<string_t, const struct node*>> {
+    std::shared_ptr<const define_table> fallback;
+
+    const mapped_type* lookup(symbol_t name) const {
+        for (const define_table* table = this; table; table = table->fallback.get()) {
+            auto iter = table->find(name);
+            if (table->end() != iter) {
+                return &iter->second;
+            }
+        }
+
+        return nullptr;
+    }
+};
+using define_map_ptr = std::shared_ptr<define_table>;
+
+struct function_call {
+    symbol_t                name;
+    string_t                variables;
+    const struct node*      rule = nullptr;
+};
 
 struct operater {
     enum operater_type {
@@ -50,16 +75,6 @@ struct operater {
         BINARY
     };
 
-    enum operater_attribute {
-        TYPE,
-        KIND,
-        PRIORITY,
-        NAME,
-        ALIAS,
-        COMMENT,
-        POSTPOSE
-    };
-
     // extradefs(expr::operater::operater_code) // type // kind // priority // name // alias // comment // postpose
     enum operater_code {
         // logic
@@ -175,7 +190,7 @@ struct operater {
     bool                    postpose;
     union {
         operater_code       code;
-        string_t*           function;
+        function_call*      function;
     };
 };
 
@@ -187,12 +202,8 @@ struct object {
         STRING,
         PARAM,
         VARIABLE,
-        ARRAY
-    };
-
-    enum object_attribute {
-        NAME,
-        ALIAS
+        ARRAY,
+        REAL_ARRAY
     };
 
     // extradefs(expr::object::object_constant) // name // alias
@@ -210,9 +221,10 @@ struct object {
         real_t              real;
         real_t              imaginary;
         string_t*           string;
-        string_t*           param;
+        symbol_t            param;
         char_t              variable;
         node_array*         array;
+        real_array*         reals;
     };
 };
 
@@ -233,6 +245,8 @@ struct node {
         RIGHT
     };
 
+    static const size_t HEADER_SIZE = alignof(std::max_align_t);
+
     node_type               type;
     node*                   super;
     node*                   parent;
@@ -251,32 +265,81 @@ struct node {
     }
 
     ~node() {
-        delete defines;
+        if (pooled()) {
+            return;
+        }
+
+        node_array garbage;
+        release(garbage);
+        while (!garbage.empty()) {
+            node* nd = garbage.back();
+            garbage.pop_back();
+            nd->release(garbage);
+            delete nd;
+        }
+    }
+
+    static void* operator new(size_t size) {
+        arena* current = arena::current();
+        char* base = static_cast<char*>(current ? current->allocate(size + HEADER_SIZE) : allocate_block(size + HEADER_SIZE));
+        *reinterpret_cast<arena**>(base) = current;
+        return base + HEADER_SIZE;
+    }
+
+    static void operator delete(void* ptr, size_t size) {
+        char* base = static_cast<char*>(ptr) - HEADER_SIZE;
+        if (ptr && !*reinterpret_cast<arena**>(base)) {
+            deallocate_block(base, size + HEADER_SIZE);
+        }
+    }
+
+    bool pooled() const {
+        return nullptr != *reinterpret_cast<arena* const*>(reinterpret_cast<const char*>(this) - HEADER_SIZE);
+    }
+
+    void release(node_array& garbage) {
+        if (defines) {
+            garbage.push_back(defines);
+            defines = nullptr;
+        }
+
         switch (type) {
         case OBJECT:
             switch (obj.type) {
             case object::STRING:
-                delete obj.string;
-                break;
-            case object::PARAM:
-                delete obj.param;
+                free_payload(obj.string);
+                obj.string = nullptr;
                 break;
             case object::ARRAY:
                 if (obj.array) {
                     for (node* item : *(obj.array)) {
-                        delete item;
+                        if (item) {
+                            garbage.push_back(item);
+                        }
                     }
-                    delete obj.array;
+                    free_payload(obj.array);
+                    obj.array = nullptr;
                 }
                 break;
+            case object::REAL_ARRAY:
+                free_payload(obj.reals);
+                obj.reals = nullptr;
+                break;
             }
             break;
         case EXPR:
             if (is_function()) {
-                delete expr.oper.function;
+                free_payload(expr.oper.function);
+                expr.oper.function = nullptr;
+            }
+            if (expr.left) {
+                garbage.push_back(expr.left);
+                expr.left = nullptr;
+            }
+            if (expr.right) {
+                garbage.push_back(expr.right);
+                expr.right = nullptr;
             }
-            delete expr.left;
-            delete expr.right;
             break;
         }
     }
@@ -313,6 +376,10 @@ struct node {
         return is_object() && object::ARRAY == obj.type;
     }
 
+    bool is_real_array() const {
+        return is_object() && object::REAL_ARRAY == obj.type;
+    }
+
     bool is_numeric() const {
         return is_real() || is_imaginary();
     }
@@ -418,19 +485,21 @@ struct node {
     }
 
     define_map_ptr define_map() const {
-        node* def = nullptr;
         for (const node* nd = this; nd; nd = nd->upper()) {
             if (nd->defines && nd->defines->is_array()) {
-                def = nd->defines;
-                break;
+                return make_define_map(nd->defines);
             }
         }
 
-        if (!def) {
+        return nullptr;
+    }
+
+    static define_map_ptr make_define_map(const node* def) {
+        if (!def || !def->is_array()) {
             return nullptr;
         }
 
-        define_map_ptr dm = std::make_shared<define_map_ptr::element_type>();
+        define_map_ptr dm = std::make_shared<define_table>();
         for (const node* item : *def->obj.array) {
             if (!item || !item->is_relation() || operater::EQUAL != item->expr.oper.code) {
                 continue;
@@ -447,7 +516,7 @@ struct node {
             }
 
             string_t variables = function->function_variables();
-            dm->emplace(*function->expr.oper.function, std::make_pair(variables, rule));
+            dm->emplace(function->expr.oper.function->name, std::make_pair(variables, rule));
         }
 
         if (dm->empty())
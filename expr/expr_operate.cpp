@@ -23,8 +23,10 @@
 */
 
 #include "expr_operate.h"
+#include <mutex>
 #include <unordered_set>
 #include <numeric>
+#include <random>
 #include <regex>
 
 namespace expr {
@@ -39,8 +41,8 @@ public:
 public:
     static bool test_number(size_t num, number_type type) {
         if (1 < num) {
-            generate_bitmap(num + 1);
-            return PRIME == type ? s_bitmap[num] : !s_bitmap[num];
+            bitmap_ptr bitmap = get_bitmap(num + 1);
+            return PRIME == type ? (*bitmap)[num] : !(*bitmap)[num];
         }
 
         return false;
@@ -56,9 +58,9 @@ public:
 
     static size_t nth_number(size_t nth, number_type type) {
         size_t m = std::max(nth, MIN_ESTIMATE);
-        generate_bitmap(PRIME == type ? static_cast<size_t>(m * (log(m) + log(log(m)))) : m * 2);
-        for (size_t count = 0, num = 2; num < s_bitmap.size(); ++num) {
-            if (PRIME == type ? s_bitmap[num] : !s_bitmap[num]) {
+        bitmap_ptr bitmap = get_bitmap(PRIME == type ? static_cast<size_t>(m * (log(m) + log(log(m)))) : m * 2);
+        for (size_t count = 0, num = 2; num < bitmap->size(); ++num) {
+            if (PRIME == type ? (*bitmap)[num] : !(*bitmap)[num]) {
                 if (count == nth) {
                     return num;
                 }
@@ -78,34 +80,54 @@ public:
     }
 
 private:
-    static void generate_bitmap(size_t size) {
-        if (size <= s_bitmap.size()) {
-            return;
+    using bitmap_ptr = std::shared_ptr<const std::vector<bool>>;
+
+    static bitmap_ptr get_bitmap(size_t size) {
+        bitmap_ptr bitmap = std::atomic_load(&s_bitmap);
+        if (bitmap && size <= bitmap->size()) {
+            return bitmap;
+        }
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+        bitmap = std::atomic_load(&s_bitmap);
+        if (bitmap && size <= bitmap->size()) {
+            return bitmap;
         }
 
         size = std::max(size + size / 2, MIN_BITMAP_SIZE);
-        s_bitmap.resize(size, true);
-        s_bitmap[0] = s_bitmap[1] = false;
+        std::shared_ptr<std::vector<bool>> sieve = std::make_shared<std::vector<bool>>(size, true);
+        (*sieve)[0] = (*sieve)[1] = false;
 
         size_t upper = static_cast<size_t>(sqrt(size));
         for (size_t m = 2; m <= upper; ++m) {
-            if (s_bitmap[m]) {
+            if ((*sieve)[m]) {
                 for (size_t n = m * m; n < size; n += m) {
-                    s_bitmap[n] = false;
+                    (*sieve)[n] = false;
                 }
             }
         }
+
+        bitmap = sieve;
+        std::atomic_store(&s_bitmap, bitmap);
+        return bitmap;
     }
 
 private:
     static const size_t MIN_ESTIMATE;
     static const size_t MIN_BITMAP_SIZE;
-    static std::vector<bool> s_bitmap;
+    static bitmap_ptr s_bitmap;
+    static std::mutex s_mutex;
 };
 
 const size_t prime_composite::MIN_ESTIMATE = 100;
 const size_t prime_composite::MIN_BITMAP_SIZE = 10000;
-std::vector<bool> prime_composite::s_bitmap;
+prime_composite::bitmap_ptr prime_composite::s_bitmap;
+std::mutex prime_composite::s_mutex;
+
+static int random_number() {
+    static thread_local std::mt19937 engine(std::random_device{}());
+    return std::uniform_int_distribution<int>(0, RAND_MAX)(engine);
+}
 
 variant operate(const variant& left, const operater& oper, const variant& right) {
     switch (oper.type) {
@@ -322,7 +344,7 @@ variant operate(real_t left, const operater& oper, real_t right) {
         case operater::NTH_COMPOSITE:
             return 0 <= right ? prime_composite::nth_composite(static_cast<size_t>(right)) : variant();
         case operater::RAND:
-            return 0 != right ? fmod(rand(), right) : real_t(rand());
+            return 0 != right ? fmod(random_number(), right) : real_t(random_number());
         }
         break;
     }
@@ -440,6 +462,135 @@ variant operate(const string_t& left, const operater& oper, const string_t& righ
     return variant();
 }
 
+static variant operate_reals(const operater& oper, const real_array& values) {
+    size_t size = values.size();
+    switch (oper.code) {
+    case operater::MIN:
+        return *std::min_element(values.begin(), values.end());
+    case operater::MAX:
+        return *std::max_element(values.begin(), values.end());
+    case operater::RANGE:
+    case operater::NORM: {
+        auto pair = std::minmax_element(values.begin(), values.end());
+        real_t range = *pair.second - *pair.first;
+        if (operater::RANGE == oper.code) {
+            return range;
+        }
+
+        if (0 == range) {
+            return sequence_t(size, 0.5);
+        }
+
+        sequence_t res(size);
+        real_t min = *pair.first;
+        std::transform(values.begin(), values.end(), res.begin(), [min, range](real_t value) { return (value - min) / range; });
+        return res;
+    }
+    case operater::TOTAL:
+    case operater::MEAN:
+    case operater::VARIANCE:
+    case operater::DEVIATION:
+    case operater::ZSCORE_NORM: {
+        real_t total = std::accumulate(values.begin(), values.end(), real_t(0));
+        if (operater::TOTAL == oper.code) {
+            return total;
+        }
+
+        real_t mean = total / size;
+        if (operater::MEAN == oper.code) {
+            return mean;
+        }
+
+        real_t variance = std::accumulate(values.begin(), values.end(), real_t(0), [mean](real_t acc, real_t value) {
+            real_t diff = value - mean;
+            return acc + diff * diff;
+        }) / size;
+        if (operater::VARIANCE == oper.code) {
+            return variance;
+        }
+
+        real_t stddev = sqrt(variance);
+        if (operater::DEVIATION == oper.code) {
+            return stddev;
+        }
+
+        if (0 == stddev) {
+            return sequence_t(size, 0);
+        }
+
+        sequence_t res(size);
+        std::transform(values.begin(), values.end(), res.begin(), [mean, stddev](real_t value) { return (value - mean) / stddev; });
+        return res;
+    }
+    case operater::GEOMETRIC_MEAN: {
+        real_t total = std::accumulate(values.begin(), values.end(), real_t(1), std::multiplies<real_t>());
+        return pow(total, real_t(1) / size);
+    }
+    case operater::QUADRATIC_MEAN:
+    case operater::HYPOT: {
+        real_t total = std::accumulate(values.begin(), values.end(), real_t(0), [](real_t acc, real_t value) {
+            return acc + value * value;
+        });
+        return sqrt(operater::QUADRATIC_MEAN == oper.code ? total / size : total);
+    }
+    case operater::HARMONIC_MEAN: {
+        real_t total = std::accumulate(values.begin(), values.end(), real_t(0), [](real_t acc, real_t value) {
+            return acc + 1 / value;
+        });
+        return size / total;
+    }
+    case operater::MEDIAN: {
+        real_array sorted(values);
+        std::sort(sorted.begin(), sorted.end());
+        size_t index = size / 2;
+        return (size % 2) ? sorted[index] : (sorted[index - 1] + sorted[index]) / 2;
+    }
+    case operater::MODE: {
+        std::map<real_t, size_t> counters;
+        for (real_t value : values) {
+            ++counters[value];
+        }
+
+        using counter_t = decltype(counters)::const_reference;
+        return std::max_element(counters.begin(), counters.end(), [](counter_t c1, counter_t c2) {
+            return c1.second < c2.second;
+        })->first;
+    }
+    case operater::GCD:
+    case operater::LCM: {
+        auto gcd = [](size_t m, size_t n) {
+            while (n) {
+                size_t temp = n;
+                n = m % n;
+                m = temp;
+            }
+            return m;
+        };
+
+        auto lcm = [&gcd](size_t m, size_t n) {
+            return m && n ? (m / gcd(m, n)) * n : 0;
+        };
+
+        size_t res = static_cast<size_t>(fabs(values[0]));
+        for (size_t index = 1; index < size; ++index) {
+            size_t value = static_cast<size_t>(fabs(values[index]));
+            if (operater::GCD == oper.code) {
+                res = gcd(res, value);
+                if (1 == res) {
+                    break;
+                }
+            } else {
+                res = lcm(res, value);
+            }
+        }
+
+        return res;
+    }
+    }
+
+    return variant();
+}
+
 variant operate(const operater& oper, const sequence_t& right) {
     if (operater::EVALUATION == oper.type) {
         const sequence_t& sequence = (1 == right.size() && right[0].is_sequence() ? *right[0].sequence : right);
@@ -549,133 +700,36 @@ variant operate(const operater& oper, const sequence_t& right) {
             return variant();
         }
 
-        std::vector<real_t> values(size);
+        real_array values(size);
         std::transform(sequence.begin(), sequence.end(), values.begin(), [](const variant& var) { return var.to_real(); });
-        switch (oper.code) {
-        case operater::MIN:
-            return *std::min_element(values.begin(), values.end());
-        case operater::MAX:
-            return *std::max_element(values.begin(), values.end());
-        case operater::RANGE:
-        case operater::NORM: {
-            auto pair = std::minmax_element(values.begin(), values.end());
-            real_t range = *pair.second - *pair.first;
-            if (operater::RANGE == oper.code) {
-                return range;
-            }
-
-            if (0 == range) {
-                return sequence_t(size, 0.5);
-            }
-
-            sequence_t res(size);
-            real_t min = *pair.first;
-            std::transform(values.begin(), values.end(), res.begin(), [min, range](real_t value) { return (value - min) / range; });
-            return res;
-        }
-        case operater::TOTAL:
-        case operater::MEAN:
-        case operater::VARIANCE:
-        case operater::DEVIATION:
-        case operater::ZSCORE_NORM: {
-            real_t total = std::accumulate(values.begin(), values.end(), real_t(0));
-            if (operater::TOTAL == oper.code) {
-                return total;
-            }
-
-            real_t mean = total / size;
-            if (operater::MEAN == oper.code) {
-                return mean;
-            }
-
-            real_t variance = std::accumulate(values.begin(), values.end(), real_t(0), [mean](real_t acc, real_t value) {
-                real_t diff = value - mean;
-                return acc + diff * diff;
-            }) / size;
-            if (operater::VARIANCE == oper.code) {
-                return variance;
-            }
-
-            real_t stddev = sqrt(variance);
-            if (operater::DEVIATION == oper.code) {
-                return stddev;
-            }
+        return operate_reals(oper, values);
+    }
 
-            if (0 == stddev) {
-                return sequence_t(size, 0);
-            }
+    return variant();
+}
 
-            sequence_t res(size);
-            std::transform(values.begin(), values.end(), res.begin(), [mean, stddev](real_t value) { return (value - mean) / stddev; });
-            return res;
-        }
-        case operater::GEOMETRIC_MEAN: {
-            real_t total = std::accumulate(values.begin(), values.end(), real_t(1), std::multiplies<real_t>());
-            return pow(total, real_t(1) / size);
-        }
-        case operater::QUADRATIC_MEAN:
-        case operater::HYPOT: {
-            real_t total = std::accumulate(values.begin(), values.end(), real_t(0), [](real_t acc, real_t value) {
-                return acc + value * value;
-            });
-            return sqrt(operater::QUADRATIC_MEAN == oper.code ? total / size : total);
-        }
-        case operater::HARMONIC_MEAN: {
-            real_t total = std::accumulate(values.begin(), values.end(), real_t(0), [](real_t acc, real_t value) {
-                return acc + 1 / value;
-            });
-            return size / total;
-        }
-        case operater::MEDIAN: {
-            std::sort(values.begin(), values.end());
-            size_t index = size / 2;
-            return (size % 2) ? values[index] : (values[index - 1] + values[index]) / 2;
-        }
-        case operater::MODE: {
-            std::map<real_t, size_t> counters;
-            for (real_t value : values) {
-                ++counters[value];
-            }
+variant operate(const operater& oper, const real_array& right) {
+    if (operater::EVALUATION != oper.type) {
+        return variant();
+    }
 
-            using counter_t = decltype(counters)::const_reference;
-            return std::max_element(counters.begin(), counters.end(), [](counter_t c1, counter_t c2) {
-                return c1.second < c2.second;
-            })->first;
-        }
-        case operater::GCD:
-        case operater::LCM: {
-            auto gcd = [](size_t m, size_t n) {
-                while (n) {
-                    size_t temp = n;
-                    n = m % n;
-                    m = temp;
-                }
-                return m;
-            };
-
-            auto lcm = [&gcd](size_t m, size_t n) {
-                return m && n ? (m / gcd(m, n)) * n : 0;
-            };
-
-            size_t res = static_cast<size_t>(fabs(values[0]));
-            for (size_t index = 1; index < size; ++index) {
-                size_t value = static_cast<size_t>(fabs(values[index]));
-                if (operater::GCD == oper.code) {
-                    res = gcd(res, value);
-                    if (1 == res) {
-                        break;
-                    }
-                } else {
-                    res = lcm(res, value);
-                }
-            }
+    switch (oper.code) {
+    case operater::COUNT:
+        return right.size();
+    case operater::UNIQUE:
+    case operater::DFT:
+    case operater::IDFT:
+    case operater::FFT:
+    case operater::IFFT:
+    case operater::ZT:
+        return operate(oper, sequence_t(right.begin(), right.end()));
+    }
 
-            return res;
-        }
-        }
+    if (right.empty()) {
+        return variant();
     }
 
-    return variant();
+    return operate_reals(oper, right);
 }
 
 }
@@ -35,6 +35,7 @@ variant operate(real_t left, const operater& oper, real_t right);
 variant operate(const complex_t& left, const operater& oper, const complex_t& right);
 variant operate(const string_t& left, const operater& oper, const string_t& right);
 variant operate(const operater& oper, const sequence_t& right);
+variant operate(const operater& oper, const real_array& right);
 
 }
 
@@ -0,0 +1,173 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_pool.h"
+#include <mutex>
+#include <vector>
+
+namespace expr {
+
+const size_t POOL_CLASS_SIZE    = 16;
+const size_t POOL_CLASS_COUNT   = 16;
+const size_t POOL_REFILL_COUNT  = 128;
+const size_t POOL_CACHE_LIMIT   = 4096;
+
+std::atomic<memory_resource*> memory_resource::s_current(nullptr);
+
+void memory_resource::set_current(memory_resource* resource) {
+    s_current.store(resource, std::memory_order_relaxed);
+}
+
+struct free_block {
+    free_block* next;
+};
+
+struct free_list {
+    free_block* head;
+    size_t count;
+};
+
+struct pool_depot {
+    std::mutex mutex;
+    free_list lists[POOL_CLASS_COUNT];
+    std::vector<char*> chunks;
+};
+
+static thread_local free_list t_lists[POOL_CLASS_COUNT];
+static thread_local bool t_exited = false;
+
+static pool_depot& depot() {
+    static pool_depot* instance = new pool_depot();
+    return *instance;
+}
+
+static void push_block(free_list& list, void* ptr) {
+    free_block* block = static_cast<free_block*>(ptr);
+    block->next = list.head;
+    list.head = block;
+    ++list.count;
+}
+
+static void* pop_block(free_list& list) {
+    free_block* block = list.head;
+    list.head = block->next;
+    --list.count;
+    return block;
+}
+
+static void move_blocks(free_list& from, free_list& to, size_t count) {
+    while (count-- && from.head) {
+        push_block(to, pop_block(from));
+    }
+}
+
+// the depot lock is held
+static void fill_depot(pool_depot& shared, size_t index) {
+    free_list& list = shared.lists[index];
+    if (!list.head) {
+        size_t size = (index + 1) * POOL_CLASS_SIZE;
+        char* chunk = static_cast<char*>(::operator new(size * POOL_REFILL_COUNT));
+        shared.chunks.push_back(chunk);
+        for (size_t i = POOL_REFILL_COUNT; 0 < i--;) {
+            push_block(list, chunk + i * size);
+        }
+    }
+}
+
+struct pool_flusher {
+    bool registered = false;
+
+    ~pool_flusher() {
+        t_exited = true;
+        pool_depot& shared = depot();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        for (size_t i = 0; i < POOL_CLASS_COUNT; ++i) {
+            move_blocks(t_lists[i], shared.lists[i], t_lists[i].count);
+        }
+    }
+};
+
+static thread_local pool_flusher t_flusher;
+
+static void refill(size_t index) {
+    t_flusher.registered = true;
+    pool_depot& shared = depot();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    fill_depot(shared, index);
+    move_blocks(shared.lists[index], t_lists[index], POOL_REFILL_COUNT);
+}
+
+void* pool_resource::allocate(size_t size) {
+    return allocate_block(size);
+}
+
+void pool_resource::deallocate(void* ptr, size_t size) {
+    deallocate_block(ptr, size);
+}
+
+void* pool_resource::allocate_block(size_t size) {
+    size_t index = (size - 1) / POOL_CLASS_SIZE;
+    if (POOL_CLASS_COUNT <= index) {
+        return ::operator new(size);
+    }
+
+    if (t_exited) {
+        pool_depot& shared = depot();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        fill_depot(shared, index);
+        return pop_block(shared.lists[index]);
+    }
+
+    free_list& list = t_lists[index];
+    if (!list.head) {
+        refill(index);
+    }
+
+    return pop_block(list);
+}
+
+void pool_resource::deallocate_block(void* ptr, size_t size) {
+    size_t index = (size - 1) / POOL_CLASS_SIZE;
+    if (!ptr || POOL_CLASS_COUNT <= index) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    if (t_exited) {
+        pool_depot& shared = depot();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        push_block(shared.lists[index], ptr);
+        return;
+    }
+
+    free_list& list = t_lists[index];
+    push_block(list, ptr);
+    if (POOL_CACHE_LIMIT < list.count) {
+        pool_depot& shared = depot();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        move_blocks(list, shared.lists[index], POOL_CACHE_LIMIT / 2);
+    }
+}
+
+}
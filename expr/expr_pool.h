@@ -0,0 +1,90 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EXPR_POOL_H
+#define EXPR_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace expr {
+
+// installed before any payload exists and outlives them all
+class memory_resource {
+public:
+    virtual ~memory_resource() = default;
+
+public:
+    virtual void* allocate(size_t size) = 0;
+    virtual void deallocate(void* ptr, size_t size) = 0;
+
+    static memory_resource* current() {
+        return s_current.load(std::memory_order_relaxed);
+    }
+
+    static void set_current(memory_resource* resource);
+
+private:
+    static std::atomic<memory_resource*> s_current;
+};
+
+// free lists per size class and thread
+class pool_resource : public memory_resource {
+public:
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr, size_t size) override;
+
+    static void* allocate_block(size_t size);
+    static void deallocate_block(void* ptr, size_t size);
+};
+
+inline void* allocate_block(size_t size) {
+    memory_resource* resource = memory_resource::current();
+    return resource ? resource->allocate(size) : pool_resource::allocate_block(size);
+}
+
+inline void deallocate_block(void* ptr, size_t size) {
+    memory_resource* resource = memory_resource::current();
+    resource ? resource->deallocate(ptr, size) : pool_resource::deallocate_block(ptr, size);
+}
+
+template<class value_t, class... args_t>
+value_t* make_payload(args_t&&... args) {
+    void* ptr = allocate_block(sizeof(value_t));
+    return new (ptr) value_t(std::forward<args_t>(args)...);
+}
+
+template<class value_t>
+void free_payload(value_t* payload) {
+    if (payload) {
+        payload->~value_t();
+        deallocate_block(payload, sizeof(value_t));
+    }
+}
+
+}
+
+#endif
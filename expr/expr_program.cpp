@@ -0,0 +1,1957 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_program.h"
+#include <cmath>
+#include <map>
+#include "expr_link.h"
+#include "expr_operate.h"
+
+#define EXTRA_EXPR_NODE
+#include "extradefs.h"
+
+namespace expr {
+
+const size_t MAX_GENERATE_SIZE      = 10000000;
+const size_t INTEGRATE_PIECE_SIZE   = 1000000;
+const size_t INTEGRATE2_PIECE_SIZE  = 8000;
+const size_t INTEGRATE3_PIECE_SIZE  = 500;
+const size_t TYPED_LOCAL_SLOTS      = 32;
+
+const uint32_t program::NONE;
+const uint32_t program::SHARED;
+
+struct program::bindings {
+    const calc_assist* assist;
+    std::vector<variant> values;
+    std::vector<bool> resolved;
+};
+
+struct program::frame {
+    bindings* params;
+    const handler::variable_replacer* vr;
+    const variant* args;
+    size_t count;
+    const variant* const* locals;
+};
+
+struct program::scalar {
+    real_t real;
+    real_t imag;
+};
+
+struct program::builder {
+    struct pending {
+        const node* root;
+        bool arguments;
+        string_t parameters;
+        size_t bound;
+    };
+
+    std::vector<pending> queue;
+    std::map<const node*, uint32_t> rules;
+};
+
+static size_t lambda_bound(operater::operater_code code, size_t position) {
+    switch (code) {
+    case operater::GENERATE:
+        return position < 2 ? position + 1 : 0;
+    case operater::HAS:
+    case operater::PICK:
+    case operater::SELECT:
+    case operater::TRANSFORM:
+        return 1 == position ? 3 : 0;
+    case operater::SORT:
+        return 1 == position ? 2 : 0;
+    case operater::ACCUMULATE:
+        return 1 == position ? 4 : 0;
+    case operater::SUMMATE:
+    case operater::PRODUCE:
+    case operater::INTEGRATE:
+        return 2 == position ? 1 : 0;
+    case operater::DOUBLE_INTEGRATE:
+        return 4 == position ? 2 : 0;
+    case operater::TRIPLE_INTEGRATE:
+        return 6 == position ? 3 : 0;
+    }
+
+    return 0;
+}
+
+static program::instruction::instruction_code specialize(operater::operater_code code, uint32_t left, uint32_t right) {
+    using instruction = program::instruction;
+    if (program::NONE == right) {
+        return instruction::OPERATE;
+    }
+
+    if (program::NONE == left) {
+        return operater::NEGATIVE == code ? instruction::NEGATIVE : instruction::OPERATE;
+    }
+
+    switch (code) {
+    case operater::PLUS:
+        return instruction::PLUS;
+    case operater::MINUS:
+        return instruction::MINUS;
+    case operater::MULTIPLY:
+        return instruction::MULTIPLY;
+    case operater::DIVIDE:
+        return instruction::DIVIDE;
+    case operater::POW:
+        return instruction::POW;
+    case operater::LESS:
+        return instruction::LESS;
+    case operater::LESS_EQUAL:
+        return instruction::LESS_EQUAL;
+    case operater::GREATER:
+        return instruction::GREATER;
+    case operater::GREATER_EQUAL:
+        return instruction::GREATER_EQUAL;
+    case operater::EQUAL:
+        return instruction::EQUAL;
+    case operater::NOT_EQUAL:
+        return instruction::NOT_EQUAL;
+    }
+
+    return instruction::OPERATE;
+}
+
+static const uint8_t UNSET_TYPE = 0xff;
+static const uint8_t MISSING_TYPE = 0xfe;
+static const uint8_t ANY_TYPE = program::ANY;
+
+static uint8_t real_type(const operater& oper) {
+    switch (oper.type) {
+    case operater::RELATION:
+        return program::BOOLEAN;
+    case operater::ARITHMETIC:
+        return operater::POLAR == oper.code ? program::COMPLEX : program::REAL;
+    }
+
+    return program::ANY;
+}
+
+static uint8_t complex_type(const operater& oper) {
+    switch (oper.code) {
+    case operater::EQUAL:
+    case operater::APPROACH:
+    case operater::NOT_EQUAL:
+        return program::BOOLEAN;
+    case operater::ABS:
+    case operater::PHASE:
+    case operater::REAL:
+    case operater::IMAGINARY:
+        return program::REAL;
+    case operater::PLUS:
+    case operater::MINUS:
+    case operater::MULTIPLY:
+    case operater::DIVIDE:
+    case operater::NEGATIVE:
+    case operater::CONJUGATE:
+    case operater::POW:
+    case operater::EXP:
+    case operater::LOG:
+    case operater::LG:
+    case operater::LN:
+    case operater::SQRT:
+    case operater::ROOT:
+    case operater::SIN:
+    case operater::ARCSIN:
+    case operater::COS:
+    case operater::ARCCOS:
+    case operater::TAN:
+    case operater::ARCTAN:
+    case operater::COT:
+    case operater::ARCCOT:
+    case operater::SEC:
+    case operater::ARCSEC:
+    case operater::CSC:
+    case operater::ARCCSC:
+        return program::COMPLEX;
+    }
+
+    return program::ANY;
+}
+
+static uint8_t operate_type(const operater& oper, uint8_t left, uint8_t right) {
+    for (uint8_t type : {left, right}) {
+        if (UNSET_TYPE == type || program::ANY == type) {
+            return type;
+        }
+    }
+
+    const bool prefix = (operater::UNARY == oper.kind && !oper.postpose);
+    switch (oper.type) {
+    case operater::LOGIC:
+        if (MISSING_TYPE != left && MISSING_TYPE != right && program::COMPLEX != left && program::COMPLEX != right) {
+            switch (oper.code) {
+            case operater::AND:
+            case operater::OR:
+            case operater::NOT:
+                return program::BOOLEAN;
+            }
+        }
+        break;
+    case operater::RELATION:
+    case operater::ARITHMETIC:
+        switch (right) {
+        case program::REAL:
+            if (program::REAL == left) {
+                return real_type(oper);
+            }
+            if (program::COMPLEX == left) {
+                return complex_type(oper);
+            }
+            return prefix ? real_type(oper) : ANY_TYPE;
+        case program::COMPLEX:
+            if (program::REAL == left || program::COMPLEX == left) {
+                return complex_type(oper);
+            }
+            return prefix ? complex_type(oper) : ANY_TYPE;
+        default:
+            if (operater::UNARY == oper.kind && oper.postpose) {
+                if (program::REAL == left) {
+                    return real_type(oper);
+                }
+                if (program::COMPLEX == left) {
+                    return complex_type(oper);
+                }
+            }
+            break;
+        }
+        break;
+    }
+
+    return program::ANY;
+}
+
+static bool unbox(const variant& value, program::value_type type, real_t& real, real_t& imag) {
+    switch (type) {
+    case program::BOOLEAN:
+        if (value.is_boolean()) {
+            real = value.boolean;
+            return true;
+        }
+        break;
+    case program::REAL:
+        if (value.is_real()) {
+            real = value.real;
+            return true;
+        }
+        break;
+    case program::COMPLEX:
+        if (value.is_complex()) {
+            real = value.complex->real();
+            imag = value.complex->imag();
+            return true;
+        }
+        break;
+    }
+
+    return false;
+}
+
+static variant box(real_t real, real_t imag, program::value_type type) {
+    switch (type) {
+    case program::BOOLEAN:
+        return 0 != real;
+    case program::REAL:
+        return real;
+    case program::COMPLEX:
+        return complex_t(real, imag);
+    }
+
+    return variant();
+}
+
+class slot_frame {
+public:
+    explicit slot_frame(size_t capacity)
+        : m_slots(capacity <= LOCAL_SLOTS ? reinterpret_cast<variant*>(m_local) : static_cast<variant*>(::operator new(capacity * sizeof(variant)))) {}
+    slot_frame(const slot_frame& other) = delete;
+
+    ~slot_frame() {
+        for (size_t n = 0; n < m_size; ++n) {
+            m_slots[n].~variant();
+        }
+        if (reinterpret_cast<variant*>(m_local) != m_slots) {
+            ::operator delete(m_slots);
+        }
+    }
+
+    slot_frame& operator=(const slot_frame& other) = delete;
+
+    variant* slots() const {
+        return m_slots;
+    }
+
+    variant* next() const {
+        return m_slots + m_size;
+    }
+
+    void commit() {
+        ++m_size;
+    }
+
+private:
+    static const size_t LOCAL_SLOTS = 16;
+
+    typename std::aligned_storage<sizeof(variant), alignof(variant)>::type m_local[LOCAL_SLOTS];
+    variant* m_slots;
+    size_t m_size = 0;
+};
+
+program::program(const node* root) {
+    builder bd;
+    add_routine(bd, root, false, string_t(), string_t(), 0);
+    for (size_t index = 0; index < bd.queue.size(); ++index) {
+        builder::pending pd = bd.queue[index];
+        m_routines[index].begin = static_cast<uint32_t>(m_code.size());
+        compile(bd, pd.root, pd.arguments, pd.parameters, pd.bound);
+        m_routines[index].end = static_cast<uint32_t>(m_code.size());
+    }
+}
+
+variant program::calc(const calc_assist& assist) const {
+    bindings bn = {&assist, std::vector<variant>(m_params.size()), std::vector<bool>(m_params.size(), false)};
+    frame fr = {&bn, &assist.vr, nullptr, 0, nullptr};
+    const native* nt = (m_natives.empty() ? nullptr : m_natives[0].get());
+    std::vector<double> params;
+    if (nt && native_item(0, nt->variables().size(), fr, params)) {
+        std::vector<double> vars;
+        for (char_t variable : nt->variables()) {
+            variant value = assist.vr ? assist.vr(variable) : variant();
+            vars.push_back(value.is_real() ? value.real : NAN);
+        }
+        double value = nt->function()(vars.data(), params.data());
+        if (!std::isnan(value)) {
+            return nt->value(value);
+        }
+    }
+
+    variant res = run(0, fr);
+    return res.is_complex() && 0 == res.complex->imag() ? res.complex->real() : res;
+}
+
+size_t program::size() const {
+    return m_code.size();
+}
+
+size_t program::eliminate_common() {
+    m_natives.clear();
+    m_types.clear();
+    m_typed.clear();
+    size_t before = m_code.size();
+    std::vector<uint32_t> constants = common_constants();
+    std::vector<bool> impure = impure_routines();
+    auto is_impure = [this, &impure](const instruction& ins) {
+        switch (ins.code) {
+        case instruction::CALL:
+            return static_cast<bool>(impure[m_operands[ins.left]]);
+        case instruction::INVOKE:
+            for (uint32_t n = 0; n < ins.right; ++n) {
+                if (impure[m_operands[ins.left + n]]) {
+                    return true;
+                }
+            }
+            break;
+        default:
+            return ins.is_operate() && operater::RAND == ins.oper;
+        }
+        return false;
+    };
+
+    size_t count = m_routines.size();
+    std::vector<uint32_t> classes(count, NONE);
+    std::map<std::vector<uint64_t>, uint32_t> class_of;
+    auto class_ref = [&classes, count](uint32_t index) -> uint64_t {
+        return NONE != classes[index] ? classes[index] : count + index;
+    };
+    for (size_t index = count; index-- > 0;) {
+        const routine& rt = m_routines[index];
+        std::vector<uint64_t> key(rt.variables.begin(), rt.variables.end());
+        key.push_back(NONE);
+        for (uint32_t pc = rt.begin; pc < rt.end; ++pc) {
+            const instruction& ins = m_code[pc];
+            key.push_back(static_cast<uint64_t>(ins.code) << 16 | ins.oper);
+            switch (ins.code) {
+            case instruction::CONSTANT:
+                key.push_back(constants[ins.left]);
+                break;
+            case instruction::ARRAY:
+            case instruction::INVOKE:
+                key.push_back(ins.right);
+                for (uint32_t n = 0; n < ins.right; ++n) {
+                    uint32_t operand = m_operands[ins.left + n];
+                    key.push_back(instruction::INVOKE == ins.code ? class_ref(operand) : operand);
+                }
+                break;
+            case instruction::CALL:
+                key.push_back(ins.right);
+                key.push_back(class_ref(m_operands[ins.left]));
+                key.insert(key.end(), m_operands.data() + ins.left + 1, m_operands.data() + ins.left + 1 + ins.right);
+                break;
+            default:
+                key.push_back(ins.left);
+                key.push_back(ins.right);
+                break;
+            }
+        }
+        uint32_t next = static_cast<uint32_t>(class_of.size());
+        classes[index] = class_of.emplace(std::move(key), next).first->second;
+    }
+
+    std::vector<uint32_t> representative(class_of.size(), NONE);
+    std::vector<uint32_t> renumbered(count, NONE);
+    uint32_t kept = 0;
+    for (uint32_t index = 0; index < count; ++index) {
+        if (NONE == representative[classes[index]]) {
+            representative[classes[index]] = index;
+            renumbered[index] = kept++;
+        }
+    }
+    auto routine_ref = [&](uint32_t index) {
+        return renumbered[representative[classes[index]]];
+    };
+
+    std::vector<instruction> code;
+    std::vector<routine> routines;
+    std::vector<uint32_t> operands;
+    for (uint32_t index = 0; index < count; ++index) {
+        if (NONE == renumbered[index]) {
+            continue;
+        }
+
+        const routine& rt = m_routines[index];
+        uint32_t begin = static_cast<uint32_t>(code.size());
+        std::vector<uint32_t> slot_of(rt.end - rt.begin);
+        std::map<std::vector<uint64_t>, uint32_t> numbered;
+        for (uint32_t pc = rt.begin; pc < rt.end; ++pc) {
+            instruction ins = m_code[pc];
+            std::vector<uint32_t> items;
+            switch (ins.code) {
+            case instruction::CONSTANT:
+                ins.left = constants[ins.left];
+                break;
+            case instruction::CALL:
+                items.push_back(routine_ref(m_operands[ins.left]));
+                for (uint32_t n = 1; n <= ins.right; ++n) {
+                    items.push_back(slot_of[m_operands[ins.left + n] & ~SHARED]);
+                }
+                break;
+            case instruction::ARRAY:
+                for (uint32_t n = 0; n < ins.right; ++n) {
+                    items.push_back(slot_of[m_operands[ins.left + n] & ~SHARED]);
+                }
+                break;
+            case instruction::INVOKE:
+                for (uint32_t n = 0; n < ins.right; ++n) {
+                    items.push_back(routine_ref(m_operands[ins.left + n]));
+                }
+                break;
+            default:
+                if (ins.is_operate()) {
+                    ins.left = (NONE == ins.left ? NONE : slot_of[ins.left]);
+                    ins.right = (NONE == ins.right ? NONE : slot_of[ins.right]);
+                }
+                break;
+            }
+
+            uint32_t slot = static_cast<uint32_t>(code.size()) - begin;
+            if (!is_impure(m_code[pc])) {
+                std::vector<uint64_t> key = {static_cast<uint64_t>(ins.code) << 16 | ins.oper};
+                if (instruction::ARRAY == ins.code || instruction::INVOKE == ins.code || instruction::CALL == ins.code) {
+                    key.insert(key.end(), items.begin(), items.end());
+                } else {
+                    key.push_back(ins.left);
+                    key.push_back(ins.right);
+                }
+
+                auto found = numbered.emplace(std::move(key), slot);
+                if (!found.second) {
+                    slot_of[pc - rt.begin] = found.first->second;
+                    continue;
+                }
+            }
+
+            if (instruction::ARRAY == ins.code || instruction::INVOKE == ins.code || instruction::CALL == ins.code) {
+                ins.left = static_cast<uint32_t>(operands.size());
+                operands.insert(operands.end(), items.begin(), items.end());
+            }
+            slot_of[pc - rt.begin] = slot;
+            code.push_back(ins);
+        }
+
+        routines.push_back({begin, static_cast<uint32_t>(code.size()), rt.variables});
+    }
+
+    m_code.swap(code);
+    m_routines.swap(routines);
+    m_operands.swap(operands);
+    for (uint32_t index = 0; index < m_routines.size(); ++index) {
+        share_slots(index);
+    }
+    return before - m_code.size();
+}
+
+size_t program::fold_constants() {
+    const frame fr = {nullptr, nullptr, nullptr, 0, nullptr};
+    return rewrite([this, &fr](const instruction& ins, std::vector<instruction>& body, std::vector<uint32_t>& items) {
+        auto constant_at = [this, &body](uint32_t slot) -> const variant* {
+            return NONE != slot && instruction::CONSTANT == body[slot].code ? &m_constants[body[slot].left] : nullptr;
+        };
+        auto is_boolean = [&body, &constant_at](uint32_t slot) {
+            const instruction& operand = body[slot];
+            if (!operand.is_operate()) {
+                return instruction::CONSTANT == operand.code && constant_at(slot)->is_boolean();
+            }
+            operater::operater_type type = operater_of(static_cast<operater::operater_code>(operand.oper)).type;
+            return operater::LOGIC == type || operater::RELATION == type;
+        };
+        auto fold = [this, &body](const variant& value) {
+            body.push_back({instruction::CONSTANT, 0, add_constant(value), 0});
+            return static_cast<uint32_t>(body.size() - 1);
+        };
+
+        switch (ins.code) {
+        case instruction::ARRAY: {
+            sequence_t sequence;
+            for (uint32_t n = 0; n < ins.right && constant_at(items[ins.left + n]); ++n) {
+                sequence.push_back(*constant_at(items[ins.left + n]));
+            }
+            if (sequence.size() == ins.right) {
+                items.resize(ins.left);
+                return fold(sequence);
+            }
+            break;
+        }
+        case instruction::REALS:
+            return fold(execute(ins, nullptr, fr));
+        default: {
+            if (!ins.is_operate()) {
+                break;
+            }
+
+            const variant* left = constant_at(ins.left);
+            const variant* right = constant_at(ins.right);
+            if (operater::RAND != ins.oper && (left || NONE == ins.left) && (right || NONE == ins.right)) {
+                variant values[2] = {left ? *left : variant(), right ? *right : variant()};
+                return fold(execute({ins.code, ins.oper, left ? 0 : NONE, right ? 1 : NONE}, values, fr));
+            }
+
+            if ((operater::AND == ins.oper || operater::OR == ins.oper) && NONE != ins.left && NONE != ins.right) {
+                bool identity = (operater::AND == ins.oper);
+                if (left && left->is_boolean() && identity == left->boolean && is_boolean(ins.right)) {
+                    return ins.right;
+                }
+                if (right && right->is_boolean() && identity == right->boolean && is_boolean(ins.left)) {
+                    return ins.left;
+                }
+            }
+            break;
+        }
+        }
+
+        body.push_back(ins);
+        return static_cast<uint32_t>(body.size() - 1);
+    });
+}
+
+program::reduction program::reduce_strength(bool inexact) {
+    reduction rd;
+    rewrite([this, &rd, inexact](const instruction& ins, std::vector<instruction>& body, std::vector<uint32_t>& items) {
+        auto is_real = [this, &body](uint32_t slot, real_t value) {
+            if (NONE == slot || instruction::CONSTANT != body[slot].code) {
+                return false;
+            }
+            const variant& constant = m_constants[body[slot].left];
+            return constant.is_real() && value == constant.real;
+        };
+        auto operand_of = [&body](uint32_t slot, operater::operater_code code) {
+            const instruction& unary = body[slot];
+            return unary.is_operate() && code == unary.oper && NONE == unary.left ? unary.right : NONE;
+        };
+        auto emit = [&body](const instruction& rewritten) {
+            body.push_back(rewritten);
+            return static_cast<uint32_t>(body.size() - 1);
+        };
+        auto multiply = [&emit](uint32_t left, uint32_t right) {
+            return emit({instruction::MULTIPLY, operater::MULTIPLY, left, right});
+        };
+        auto number = [this, &body, &emit](uint32_t slot) {
+            const instruction& operand = body[slot];
+            bool known = (instruction::NUMBER == operand.code);
+            if (instruction::CONSTANT == operand.code) {
+                known = m_constants[operand.left].is_real() || m_constants[operand.left].is_complex();
+            } else if (operand.is_operate()) {
+                const operater& oper = operater_of(static_cast<operater::operater_code>(operand.oper));
+                known = known || (operater::ARITHMETIC == oper.type && operater::PLUS != oper.code);
+            }
+            return known ? slot : emit({instruction::NUMBER, operater::REAL, NONE, slot});
+        };
+
+        if (!ins.is_operate() || NONE == ins.right) {
+            body.push_back(ins);
+            return static_cast<uint32_t>(body.size() - 1);
+        }
+
+        instruction rewritten = ins;
+        uint32_t inner = NONE;
+        switch (ins.oper) {
+        case operater::POW:
+            if (NONE != ins.left && is_real(ins.right, 2) && NONE != (inner = operand_of(ins.left, operater::SQRT))) {
+                ++rd.sqrt_squares;
+                return number(inner);
+            }
+            if (NONE != ins.left && is_real(ins.right, 2)) {
+                ++rd.squares;
+                return multiply(ins.left, ins.left);
+            }
+            if (NONE != ins.left && is_real(ins.right, 3)) {
+                ++rd.cubes;
+                return multiply(multiply(ins.left, ins.left), ins.left);
+            }
+            break;
+        case operater::DIVIDE:
+            if (NONE != ins.left && instruction::CONSTANT == body[ins.right].code && m_constants[body[ins.right].left].is_real() &&
+                std::isnormal(1 / m_constants[body[ins.right].left].real)) {
+                int exponent = 0;
+                real_t reciprocal = 1 / m_constants[body[ins.right].left].real;
+                bool exact = (0.5 == std::fabs(std::frexp(reciprocal, &exponent)));
+                if (exact || inexact) {
+                    ++(exact ? rd.reciprocals : rd.inexact_reciprocals);
+                    rewritten = {instruction::MULTIPLY, operater::MULTIPLY, ins.left, emit({instruction::CONSTANT, 0, add_constant(reciprocal), 0})};
+                }
+            }
+            break;
+        case operater::EXP:
+            if (NONE == ins.left && NONE != (inner = operand_of(ins.right, operater::LN))) {
+                ++rd.exp_lns;
+                return number(inner);
+            }
+            break;
+        case operater::NEGATIVE:
+            if (NONE == ins.left && NONE != (inner = operand_of(ins.right, operater::NEGATIVE))) {
+                ++rd.double_negatives;
+                return number(inner);
+            }
+            break;
+        }
+
+        if (NONE != rewritten.left) {
+            switch (rewritten.oper) {
+            case operater::MULTIPLY:
+                if (is_real(rewritten.left, 1) || is_real(rewritten.right, 1)) {
+                    ++rd.multiply_ones;
+                    return number(is_real(rewritten.right, 1) ? rewritten.left : rewritten.right);
+                }
+                break;
+            case operater::PLUS:
+            case operater::MINUS:
+                if (is_real(rewritten.right, 0) || (operater::PLUS == rewritten.oper && is_real(rewritten.left, 0))) {
+                    ++rd.plus_zeros;
+                    return number(is_real(rewritten.right, 0) ? rewritten.left : rewritten.right);
+                }
+                break;
+            }
+        }
+
+        return emit(rewritten);
+    });
+
+    return rd;
+}
+
+size_t program::compile_native() {
+    m_natives.assign(m_routines.size(), nullptr);
+    auto add = [this](uint32_t index, const string_t& variables) {
+        if (!m_natives[index]) {
+            m_natives[index] = native::compile(*this, index, variables);
+        }
+    };
+
+    string_t variables;
+    for (uint32_t pc = m_routines[0].begin; pc < m_routines[0].end; ++pc) {
+        char_t variable = static_cast<char_t>(m_code[pc].left);
+        if (instruction::VARIABLE == m_code[pc].code && string_t::npos == variables.find(variable)) {
+            variables += variable;
+        }
+    }
+    add(0, variables);
+
+    for (const instruction& ins : m_code) {
+        if (instruction::INVOKE != ins.code) {
+            continue;
+        }
+
+        size_t bound = 0;
+        switch (ins.oper) {
+        case operater::SUMMATE:
+        case operater::PRODUCE:
+        case operater::INTEGRATE:
+            bound = 1;
+            break;
+        case operater::DOUBLE_INTEGRATE:
+            bound = 2;
+            break;
+        case operater::TRIPLE_INTEGRATE:
+            bound = 3;
+            break;
+        }
+
+        if (!bound || bound * 2 >= ins.right) {
+            continue;
+        }
+
+        uint32_t item = m_operands[ins.left + bound * 2];
+        if (bound <= m_routines[item].variables.size()) {
+            add(item, m_routines[item].variables.substr(0, bound));
+        }
+    }
+
+    return std::count_if(m_natives.begin(), m_natives.end(), [](const native_ptr& nt) { return nullptr != nt; });
+}
+
+size_t program::infer_types() {
+    std::vector<uint8_t> types(m_code.size(), UNSET_TYPE);
+    std::vector<uint8_t> results(m_routines.size(), UNSET_TYPE);
+    std::vector<std::vector<uint8_t>> arguments(m_routines.size());
+    std::vector<bool> rules(m_routines.size(), false);
+    for (const instruction& ins : m_code) {
+        if (instruction::CALL == ins.code) {
+            uint32_t rule = m_operands[ins.left];
+            rules[rule] = true;
+            arguments[rule].assign(m_routines[rule].variables.size(), UNSET_TYPE);
+        }
+    }
+    auto join = [](uint8_t& type, uint8_t other) {
+        uint8_t joined = (UNSET_TYPE == type ? other : (UNSET_TYPE == other || type == other ? type : ANY_TYPE));
+        bool changed = (joined != type);
+        type = joined;
+        return changed;
+    };
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (uint32_t index = 0; index < m_routines.size(); ++index) {
+            const routine& rt = m_routines[index];
+            uint8_t result = ANY_TYPE;
+            bool any = false;
+            bool unset = false;
+            for (uint32_t pc = rt.begin; pc < rt.end; ++pc) {
+                const instruction& ins = m_code[pc];
+                uint8_t type = ANY;
+                switch (ins.code) {
+                case instruction::CONSTANT:
+                    switch (m_constants[ins.left].type) {
+                    case variant::BOOLEAN:
+                        type = BOOLEAN;
+                        break;
+                    case variant::REAL:
+                        type = REAL;
+                        break;
+                    case variant::COMPLEX:
+                        type = COMPLEX;
+                        break;
+                    }
+                    break;
+                case instruction::PARAM:
+                case instruction::VARIABLE:
+                case instruction::LOCAL:
+                    type = REAL;
+                    break;
+                case instruction::ARGUMENT:
+                    if (!rules[index]) {
+                        type = REAL;
+                    } else if (ins.left < arguments[index].size()) {
+                        type = arguments[index][ins.left];
+                    }
+                    break;
+                case instruction::CALL: {
+                    uint32_t rule = m_operands[ins.left];
+                    for (uint32_t n = 0; n < arguments[rule].size(); ++n) {
+                        uint8_t passed = (n < ins.right ? types[rt.begin + (m_operands[ins.left + 1 + n] & ~SHARED)] : ANY_TYPE);
+                        changed = join(arguments[rule][n], passed) || changed;
+                    }
+                    type = results[rule];
+                    break;
+                }
+                case instruction::NUMBER: {
+                    uint8_t operand = types[rt.begin + ins.right];
+                    type = (BOOLEAN == operand ? ANY_TYPE : operand);
+                    break;
+                }
+                default:
+                    if (ins.is_operate()) {
+                        uint8_t left = (NONE == ins.left ? MISSING_TYPE : types[rt.begin + ins.left]);
+                        uint8_t right = (NONE == ins.right ? MISSING_TYPE : types[rt.begin + ins.right]);
+                        type = operate_type(operater_of(static_cast<operater::operater_code>(ins.oper)), left, right);
+                    }
+                    break;
+                }
+                changed = (type != types[pc]) || changed;
+                types[pc] = type;
+                any = any || ANY == type;
+                unset = unset || UNSET_TYPE == type;
+                if (rt.end - 1 == pc && !any) {
+                    result = (unset ? UNSET_TYPE : type);
+                }
+            }
+            changed = (result != results[index]) || changed;
+            results[index] = result;
+        }
+    }
+
+    m_types.resize(m_code.size());
+    std::transform(types.begin(), types.end(), m_types.begin(), [](uint8_t type) {
+        return UNSET_TYPE == type ? ANY : static_cast<value_type>(type);
+    });
+    m_typed.resize(m_routines.size());
+    std::transform(results.begin(), results.end(), m_typed.begin(), [](uint8_t type) {
+        return UNSET_TYPE != type && ANY != type;
+    });
+    return std::count(m_typed.begin(), m_typed.end(), true);
+}
+
+native_ptr program::native_code(uint32_t routine) const {
+    return routine < m_natives.size() ? m_natives[routine] : nullptr;
+}
+
+const std::vector<program::instruction>& program::code() const {
+    return m_code;
+}
+
+const std::vector<program::routine>& program::routines() const {
+    return m_routines;
+}
+
+const std::vector<symbol_t>& program::params() const {
+    return m_params;
+}
+
+const std::vector<program::value_type>& program::types() const {
+    return m_types;
+}
+
+bool program::typed(uint32_t routine) const {
+    return routine < m_typed.size() && m_typed[routine];
+}
+
+void program::compile(builder& bd, const node* root, bool arguments, const string_t& parameters, size_t bound) {
+    if (!root) {
+        return;
+    }
+
+    uint32_t begin = static_cast<uint32_t>(m_code.size());
+    std::vector<uint32_t> slots;
+    auto emit = [this, begin, &slots](instruction::instruction_code code, uint16_t oper, uint32_t left, uint32_t right) {
+        slots.push_back(static_cast<uint32_t>(m_code.size()) - begin);
+        m_code.push_back({code, oper, left, right});
+    };
+    auto pop_slot = [&slots]() {
+        uint32_t slot = slots.back();
+        slots.pop_back();
+        return slot;
+    };
+
+    std::vector<std::pair<const node*, bool>> stack = {{root, false}};
+    while (!stack.empty()) {
+        const node* nd = stack.back().first;
+        bool expanded = stack.back().second;
+        stack.pop_back();
+        if (!nd) {
+            emit(instruction::CONSTANT, 0, add_constant(variant()), 0);
+            continue;
+        }
+
+        if (!expanded) {
+            stack.push_back({nd, true});
+            if (nd->is_array()) {
+                const node_array& items = *nd->obj.array;
+                for (auto it = items.rbegin(); it != items.rend(); ++it) {
+                    stack.push_back({*it, false});
+                }
+            } else if (nd->is_function()) {
+                if (nd->expr.oper.function->rule && nd->expr.right && nd->expr.right->is_array()) {
+                    const node_array& items = *nd->expr.right->obj.array;
+                    for (auto it = items.rbegin(); it != items.rend(); ++it) {
+                        stack.push_back({*it, false});
+                    }
+                }
+            } else if (nd->is_expr() && !nd->is_invocation() && !nd->is_largescale() &&
+                       !(nd->is_evaluation() && nd->expr.right && nd->expr.right->is_real_array())) {
+                if (nd->expr.right) {
+                    stack.push_back({nd->expr.right, false});
+                }
+                if (nd->expr.left) {
+                    stack.push_back({nd->expr.left, false});
+                }
+            }
+            continue;
+        }
+
+        if (nd->is_object()) {
+            switch (nd->obj.type) {
+            case object::BOOLEAN:
+                emit(instruction::CONSTANT, 0, add_constant(nd->obj.boolean), 0);
+                break;
+            case object::REAL:
+                emit(instruction::CONSTANT, 0, add_constant(nd->obj.real), 0);
+                break;
+            case object::IMAGINARY:
+                emit(instruction::CONSTANT, 0, add_constant(complex_t(0, nd->obj.imaginary)), 0);
+                break;
+            case object::STRING:
+                emit(instruction::CONSTANT, 0, add_constant(*nd->obj.string), 0);
+                break;
+            case object::PARAM: {
+                auto it = std::find(m_params.begin(), m_params.end(), nd->obj.param);
+                if (m_params.end() == it) {
+                    it = m_params.insert(it, nd->obj.param);
+                }
+                emit(instruction::PARAM, 0, static_cast<uint32_t>(it - m_params.begin()), 0);
+                break;
+            }
+            case object::VARIABLE:
+                if (arguments) {
+                    size_t pos = parameters.find(nd->obj.variable);
+                    if (string_t::npos == pos) {
+                        emit(instruction::CONSTANT, 0, add_constant(variant()), 0);
+                    } else {
+                        emit(instruction::ARGUMENT, 0, static_cast<uint32_t>(pos), 0);
+                    }
+                } else if (bound) {
+                    size_t pos = std::min(parameters.find(nd->obj.variable), bound - 1);
+                    emit(instruction::LOCAL, 0, static_cast<uint32_t>(pos), 0);
+                } else {
+                    emit(instruction::VARIABLE, 0, static_cast<uint32_t>(nd->obj.variable), 0);
+                }
+                break;
+            case object::ARRAY: {
+                uint32_t count = static_cast<uint32_t>(nd->obj.array->size());
+                uint32_t first = static_cast<uint32_t>(m_operands.size());
+                m_operands.insert(m_operands.end(), slots.end() - count, slots.end());
+                slots.resize(slots.size() - count);
+                emit(instruction::ARRAY, 0, first, count);
+                break;
+            }
+            case object::REAL_ARRAY:
+                emit(instruction::CONSTANT, 0, add_constant(sequence_t(nd->obj.reals->begin(), nd->obj.reals->end())), 0);
+                break;
+            default:
+                emit(instruction::CONSTANT, 0, add_constant(variant()), 0);
+                break;
+            }
+            continue;
+        }
+
+        const operater& oper = nd->expr.oper;
+        if (nd->is_evaluation() && nd->expr.right && nd->expr.right->is_real_array()) {
+            m_reals.push_back(*nd->expr.right->obj.reals);
+            emit(instruction::REALS, static_cast<uint16_t>(oper.code), static_cast<uint32_t>(m_reals.size() - 1), 0);
+            continue;
+        }
+
+        switch (oper.type) {
+        case operater::INVOCATION:
+        case operater::LARGESCALE: {
+            if (!nd->expr.right || !nd->expr.right->is_array()) {
+                emit(instruction::CONSTANT, 0, add_constant(variant()), 0);
+                break;
+            }
+
+            const node_array& wrap = *nd->expr.right->obj.array;
+            std::vector<uint32_t> items;
+            for (size_t position = 0; position < wrap.size(); ++position) {
+                string_t variables = wrap[position] ? wrap[position]->function_variables() : string_t();
+                size_t lambda = lambda_bound(oper.code, position);
+                if (lambda && !variables.empty()) {
+                    items.push_back(add_routine(bd, wrap[position], false, variables, variables, lambda));
+                } else {
+                    items.push_back(add_routine(bd, wrap[position], arguments, parameters, string_t(), bound));
+                }
+            }
+
+            uint32_t first = static_cast<uint32_t>(m_operands.size());
+            m_operands.insert(m_operands.end(), items.begin(), items.end());
+            emit(instruction::INVOKE, static_cast<uint16_t>(oper.code), first, static_cast<uint32_t>(items.size()));
+            break;
+        }
+        case operater::FUNCTION: {
+            const function_call* call = oper.function;
+            if (!call->rule || !nd->expr.right || !nd->expr.right->is_array()) {
+                emit(instruction::CONSTANT, 0, add_constant(variant()), 0);
+                break;
+            }
+
+            auto it = bd.rules.find(call->rule);
+            uint32_t rule = (bd.rules.end() != it ? it->second : add_routine(bd, call->rule, true, call->variables, call->variables, 0));
+            bd.rules.emplace(call->rule, rule);
+            uint32_t count = static_cast<uint32_t>(nd->expr.right->obj.array->size());
+            uint32_t first = static_cast<uint32_t>(m_operands.size());
+            m_operands.push_back(rule);
+            m_operands.insert(m_operands.end(), slots.end() - count, slots.end());
+            slots.resize(slots.size() - count);
+            emit(instruction::CALL, 0, first, count);
+            break;
+        }
+        default: {
+            uint32_t right = (nd->expr.right ? pop_slot() : NONE);
+            uint32_t left = (nd->expr.left ? pop_slot() : NONE);
+            emit(specialize(oper.code, left, right), static_cast<uint16_t>(oper.code), left, right);
+            break;
+        }
+        }
+    }
+}
+
+uint32_t program::add_routine(builder& bd, const node* root, bool arguments, const string_t& parameters, const string_t& variables, size_t bound) {
+    m_routines.push_back({0, 0, variables});
+    bd.queue.push_back({root, arguments, parameters, bound});
+    return static_cast<uint32_t>(m_routines.size() - 1);
+}
+
+uint32_t program::add_constant(const variant& value) {
+    m_constants.push_back(value);
+    return static_cast<uint32_t>(m_constants.size() - 1);
+}
+
+program::instruction program::remap(instruction ins, const std::vector<uint32_t>& slot_of, std::vector<uint32_t>& items) const {
+    switch (ins.code) {
+    case instruction::ARRAY:
+    case instruction::CALL:
+    case instruction::INVOKE: {
+        uint32_t first = (instruction::CALL == ins.code ? 1 : 0);
+        uint32_t count = ins.right + first;
+        uint32_t offset = ins.left;
+        ins.left = static_cast<uint32_t>(items.size());
+        for (uint32_t n = 0; n < count; ++n) {
+            uint32_t operand = m_operands[offset + n];
+            items.push_back(instruction::INVOKE != ins.code && first <= n ? slot_of[operand & ~SHARED] : operand);
+        }
+        break;
+    }
+    default:
+        if (ins.is_operate()) {
+            ins.left = (NONE == ins.left ? NONE : slot_of[ins.left]);
+            ins.right = (NONE == ins.right ? NONE : slot_of[ins.right]);
+        }
+        break;
+    }
+
+    return ins;
+}
+
+size_t program::rewrite(const rewriter& rw) {
+    m_natives.clear();
+    m_types.clear();
+    m_typed.clear();
+    size_t before = m_code.size();
+    std::vector<instruction> code;
+    std::vector<uint32_t> operands;
+    for (routine& rt : m_routines) {
+        std::vector<instruction> body;
+        std::vector<uint32_t> items;
+        std::vector<uint32_t> slot_of(rt.end - rt.begin);
+        for (uint32_t pc = rt.begin; pc < rt.end; ++pc) {
+            slot_of[pc - rt.begin] = rw(remap(m_code[pc], slot_of, items), body, items);
+        }
+
+        std::vector<bool> live(body.size(), false);
+        if (!body.empty()) {
+            live[slot_of.back()] = true;
+        }
+        for (size_t pc = body.size(); pc-- > 0;) {
+            const instruction& ins = body[pc];
+            if (!live[pc]) {
+                continue;
+            }
+            if (instruction::ARRAY == ins.code || instruction::CALL == ins.code) {
+                uint32_t first = ins.left + (instruction::CALL == ins.code ? 1 : 0);
+                for (uint32_t n = 0; n < ins.right; ++n) {
+                    live[items[first + n]] = true;
+                }
+            } else if (ins.is_operate()) {
+                for (uint32_t operand : {ins.left, ins.right}) {
+                    if (NONE != operand) {
+                        live[operand] = true;
+                    }
+                }
+            }
+        }
+
+        uint32_t begin = static_cast<uint32_t>(code.size());
+        std::vector<uint32_t> renumbered(body.size(), NONE);
+        for (uint32_t pc = 0; pc < body.size(); ++pc) {
+            instruction ins = body[pc];
+            if (!live[pc] && (instruction::CONSTANT == ins.code || (ins.is_operate() && operater::RAND != ins.oper))) {
+                continue;
+            }
+
+            switch (ins.code) {
+            case instruction::ARRAY:
+            case instruction::CALL:
+            case instruction::INVOKE: {
+                uint32_t first = (instruction::CALL == ins.code ? 1 : 0);
+                uint32_t count = ins.right + first;
+                uint32_t offset = ins.left;
+                ins.left = static_cast<uint32_t>(operands.size());
+                for (uint32_t n = 0; n < count; ++n) {
+                    uint32_t operand = items[offset + n];
+                    operands.push_back(instruction::INVOKE != ins.code && first <= n ? renumbered[operand] : operand);
+                }
+                break;
+            }
+            default:
+                if (ins.is_operate()) {
+                    ins.left = (NONE == ins.left ? NONE : renumbered[ins.left]);
+                    ins.right = (NONE == ins.right ? NONE : renumbered[ins.right]);
+                }
+                break;
+            }
+            renumbered[pc] = static_cast<uint32_t>(code.size()) - begin;
+            code.push_back(ins);
+        }
+
+        rt.begin = begin;
+        rt.end = static_cast<uint32_t>(code.size());
+    }
+
+    m_code.swap(code);
+    m_operands.swap(operands);
+    for (uint32_t index = 0; index < m_routines.size(); ++index) {
+        share_slots(index);
+    }
+    return before - m_code.size();
+}
+
+void program::share_slots(uint32_t index) {
+    const routine& rt = m_routines[index];
+    std::vector<uint32_t> uses(rt.end - rt.begin);
+    for (uint32_t pc = rt.begin; pc < rt.end; ++pc) {
+        instruction& ins = m_code[pc];
+        if (instruction::ARRAY == ins.code || instruction::CALL == ins.code) {
+            uint32_t first = ins.left + (instruction::CALL == ins.code ? 1 : 0);
+            for (uint32_t n = 0; n < ins.right; ++n) {
+                m_operands[first + n] &= ~SHARED;
+                ++uses[m_operands[first + n]];
+            }
+        } else if (ins.is_operate()) {
+            for (uint32_t slot : {ins.left, ins.right}) {
+                if (NONE != slot) {
+                    ++uses[slot];
+                }
+            }
+        }
+    }
+    for (uint32_t pc = rt.begin; pc < rt.end; ++pc) {
+        const instruction& ins = m_code[pc];
+        if (instruction::ARRAY == ins.code || instruction::CALL == ins.code) {
+            uint32_t first = ins.left + (instruction::CALL == ins.code ? 1 : 0);
+            for (uint32_t n = 0; n < ins.right; ++n) {
+                uint32_t& operand = m_operands[first + n];
+                if (1 < uses[operand]) {
+                    operand |= SHARED;
+                }
+            }
+        }
+    }
+}
+
+std::vector<bool> program::impure_routines() const {
+    std::vector<bool> impure(m_routines.size(), false);
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t index = 0; index < m_routines.size(); ++index) {
+            const routine& rt = m_routines[index];
+            for (uint32_t pc = rt.begin; pc < rt.end && !impure[index]; ++pc) {
+                const instruction& ins = m_code[pc];
+                bool reached = (ins.is_operate() && operater::RAND == ins.oper) ||
+                               (instruction::CALL == ins.code && impure[m_operands[ins.left]]);
+                for (uint32_t n = 0; instruction::INVOKE == ins.code && n < ins.right; ++n) {
+                    reached = reached || impure[m_operands[ins.left + n]];
+                }
+                if (reached) {
+                    impure[index] = true;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    return impure;
+}
+
+std::vector<uint32_t> program::common_constants() const {
+    std::vector<uint32_t> common(m_constants.size());
+    std::map<std::pair<int, std::string>, uint32_t> seen;
+    for (uint32_t index = 0; index < m_constants.size(); ++index) {
+        const variant& value = m_constants[index];
+        std::string bytes;
+        switch (value.type) {
+        case variant::BOOLEAN:
+            bytes.assign(reinterpret_cast<const char*>(&value.boolean), sizeof(value.boolean));
+            break;
+        case variant::REAL:
+            bytes.assign(reinterpret_cast<const char*>(&value.real), sizeof(value.real));
+            break;
+        case variant::COMPLEX:
+            bytes.assign(reinterpret_cast<const char*>(value.complex), sizeof(*value.complex));
+            break;
+        case variant::STRING:
+            bytes.assign(reinterpret_cast<const char*>(value.string->data()), value.string->size() * sizeof(char_t));
+            break;
+        case variant::SEQUENCE:
+            common[index] = index;
+            continue;
+        }
+        common[index] = seen.emplace(std::make_pair(static_cast<int>(value.type), bytes), index).first->second;
+    }
+
+    return common;
+}
+
+const native* program::native_item(uint32_t index, size_t bound, const frame& fr, std::vector<double>& params) const {
+    const native* nt = (index < m_natives.size() ? m_natives[index].get() : nullptr);
+    if (!nt || nt->variables().size() != bound) {
+        return nullptr;
+    }
+
+    for (uint32_t position : nt->params()) {
+        const variant& value = param(position, fr);
+        params.push_back(value.is_real() ? value.real : NAN);
+    }
+
+    return nt;
+}
+
+const variant& program::param(uint32_t index, const frame& fr) const {
+    static const variant none;
+    if (!fr.params) {
+        return none;
+    }
+
+    bindings& bn = *fr.params;
+    if (!bn.resolved[index]) {
+        const calc_assist& assist = *bn.assist;
+        if (index < assist.count && (assist.values || assist.reals)) {
+            bn.values[index] = (assist.values ? assist.values[index] : variant(assist.reals[index]));
+        } else if (assist.pr) {
+            bn.values[index] = assist.pr(symbol_name(m_params[index]));
+        }
+        bn.resolved[index] = true;
+    }
+
+    return bn.values[index];
+}
+
+variant program::run(uint32_t index, const frame& fr) const {
+    const routine& rt = m_routines[index];
+    if (rt.begin == rt.end) {
+        return variant();
+    }
+
+    scalar res;
+    if (typed(index) && run_typed(index, fr, nullptr, nullptr, 0, res)) {
+        return box(res.real, res.imag, m_types[rt.end - 1]);
+    }
+
+    slot_frame sf(rt.end - rt.begin);
+    for (uint32_t pc = rt.begin; pc < rt.end; ++pc) {
+        new (sf.next()) variant(execute(m_code[pc], sf.slots(), fr));
+        sf.commit();
+    }
+
+    return std::move(sf.next()[-1]);
+}
+
+bool program::run_typed(uint32_t index, const frame& fr, const scalar* caller, const uint32_t* operands, size_t count, scalar& res) const {
+    const routine& rt = m_routines[index];
+    const value_type* types = &m_types[rt.begin];
+    size_t size = rt.end - rt.begin;
+    scalar local[TYPED_LOCAL_SLOTS];
+    std::vector<scalar> spilled(size <= TYPED_LOCAL_SLOTS ? 0 : size);
+    scalar* slots = (spilled.empty() ? local : spilled.data());
+
+    for (uint32_t pc = 0; pc < size; ++pc) {
+        const instruction& ins = m_code[rt.begin + pc];
+        scalar& slot = slots[pc];
+        slot.imag = 0;
+        switch (ins.code) {
+        case instruction::CONSTANT:
+            unbox(m_constants[ins.left], types[pc], slot.real, slot.imag);
+            break;
+        case instruction::PARAM:
+            if (!unbox(param(ins.left, fr), types[pc], slot.real, slot.imag)) {
+                return false;
+            }
+            break;
+        case instruction::VARIABLE:
+            if (!unbox(execute(ins, nullptr, fr), types[pc], slot.real, slot.imag)) {
+                return false;
+            }
+            break;
+        case instruction::LOCAL:
+            if (!unbox(*fr.locals[ins.left], types[pc], slot.real, slot.imag)) {
+                return false;
+            }
+            break;
+        case instruction::ARGUMENT:
+            if (caller) {
+                if (count <= ins.left) {
+                    return false;
+                }
+                slot = caller[operands[ins.left] & ~SHARED];
+            } else if (ins.left >= fr.count || !unbox(fr.args[ins.left], types[pc], slot.real, slot.imag)) {
+                return false;
+            }
+            break;
+        case instruction::CALL:
+            if (!run_typed(m_operands[ins.left], {fr.params, nullptr, nullptr, 0, nullptr}, slots, m_operands.data() + ins.left + 1, ins.right, slot)) {
+                return false;
+            }
+            break;
+        default:
+            if (!operate_typed(ins, types, slots, types[pc], slot)) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    res = slots[size - 1];
+    return true;
+}
+
+bool program::operate_typed(const instruction& ins, const value_type* types, const scalar* slots, value_type type, scalar& res) const {
+    if (instruction::NUMBER == ins.code) {
+        res = slots[ins.right];
+        return true;
+    }
+
+    const operater& oper = operater_of(static_cast<operater::operater_code>(ins.oper));
+    value_type left = (NONE == ins.left ? ANY : types[ins.left]);
+    value_type right = (NONE == ins.right ? ANY : types[ins.right]);
+    if (operater::LOGIC == oper.type) {
+        bool l = (0 != slots[ins.left].real);
+        bool r = (0 != slots[ins.right].real);
+        res.real = (operater::AND == oper.code ? l && r : (operater::OR == oper.code ? l || r : !r));
+        return true;
+    }
+
+    if (COMPLEX == left || COMPLEX == right) {
+        auto value_of = [slots](uint32_t slot, value_type type) {
+            return REAL == type || COMPLEX == type ? complex_t(slots[slot].real, slots[slot].imag) : complex_t();
+        };
+        complex_t l = value_of(ins.left, left);
+        complex_t r = value_of(ins.right, right);
+        complex_t value;
+        switch (oper.code) {
+        case operater::PLUS:
+            value = l + r;
+            break;
+        case operater::MINUS:
+            value = l - r;
+            break;
+        case operater::MULTIPLY:
+            value = l * r;
+            break;
+        case operater::DIVIDE:
+            value = l / r;
+            break;
+        case operater::NEGATIVE:
+            value = -r;
+            break;
+        case operater::CONJUGATE:
+            value = conj(r);
+            break;
+        case operater::ABS:
+            res.real = abs(r);
+            return true;
+        case operater::REAL:
+            res.real = r.real();
+            return true;
+        case operater::IMAGINARY:
+            res.real = r.imag();
+            return true;
+        case operater::EQUAL:
+            res.real = (l == r);
+            return true;
+        case operater::NOT_EQUAL:
+            res.real = (l != r);
+            return true;
+        default:
+            return unbox(operate(l, oper, r), type, res.real, res.imag);
+        }
+        res.real = value.real();
+        res.imag = value.imag();
+        return true;
+    }
+
+    real_t l = (REAL == left ? slots[ins.left].real : 0);
+    real_t r = (REAL == right ? slots[ins.right].real : 0);
+    switch (oper.code) {
+    case operater::PLUS:
+        res.real = l + r;
+        return true;
+    case operater::MINUS:
+        res.real = l - r;
+        return true;
+    case operater::MULTIPLY:
+        res.real = l * r;
+        return true;
+    case operater::DIVIDE:
+        if (0 == r) {
+            break;
+        }
+        res.real = l / r;
+        return true;
+    case operater::NEGATIVE:
+        res.real = -r;
+        return true;
+    case operater::POW:
+        if (l < 0) {
+            return false;
+        }
+        res.real = pow(l, r);
+        return true;
+    case operater::SQRT:
+        if (r < 0) {
+            return false;
+        }
+        res.real = sqrt(r);
+        return true;
+    case operater::EXP:
+        res.real = exp(r);
+        return true;
+    case operater::LN:
+        if (r < 0) {
+            return false;
+        }
+        res.real = log(r);
+        return true;
+    case operater::SIN:
+        res.real = sin(r);
+        return true;
+    case operater::COS:
+        res.real = cos(r);
+        return true;
+    case operater::ABS:
+        res.real = fabs(r);
+        return true;
+    case operater::LESS:
+        res.real = (l < r);
+        return true;
+    case operater::LESS_EQUAL:
+        res.real = (l <= r);
+        return true;
+    case operater::GREATER:
+        res.real = (l > r);
+        return true;
+    case operater::GREATER_EQUAL:
+        res.real = (l >= r);
+        return true;
+    case operater::EQUAL:
+        res.real = (l == r);
+        return true;
+    case operater::NOT_EQUAL:
+        res.real = (l != r);
+        return true;
+    }
+
+    return unbox(operate(l, oper, r), type, res.real, res.imag);
+}
+
+variant program::run_lambda(uint32_t index, const frame& fr, const variant* const* locals) const {
+    return run(index, {fr.params, nullptr, nullptr, 0, locals});
+}
+
+variant program::execute(const instruction& ins, variant* slots, const frame& fr) const {
+    static const variant none;
+    switch (ins.code) {
+    case instruction::CONSTANT:
+        return m_constants[ins.left];
+    case instruction::PARAM:
+        return param(ins.left, fr);
+    case instruction::VARIABLE:
+        return fr.vr && *fr.vr ? (*fr.vr)(static_cast<char_t>(ins.left)) : variant();
+    case instruction::LOCAL:
+        return *fr.locals[ins.left];
+    case instruction::ARGUMENT:
+        return ins.left < fr.count ? fr.args[ins.left] : variant();
+    case instruction::ARRAY: {
+        sequence_t sequence;
+        sequence.reserve(ins.right);
+        for (uint32_t n = 0; n < ins.right; ++n) {
+            uint32_t operand = m_operands[ins.left + n];
+            if (operand & SHARED) {
+                sequence.push_back(slots[operand & ~SHARED]);
+            } else {
+                sequence.emplace_back(std::move(slots[operand]));
+            }
+        }
+        return sequence;
+    }
+    case instruction::REALS:
+        return operate(operater_of(static_cast<operater::operater_code>(ins.oper)), m_reals[ins.left]);
+    case instruction::CALL: {
+        const uint32_t* operands = m_operands.data() + ins.left + 1;
+        uint32_t first = (ins.right ? operands[0] & ~SHARED : 0);
+        uint32_t n = 1;
+        while (n < ins.right && (operands[n] & ~SHARED) == first + n) {
+            ++n;
+        }
+        if (n >= ins.right) {
+            return run(operands[-1], {fr.params, nullptr, slots + first, ins.right, nullptr});
+        }
+
+        sequence_t args;
+        args.reserve(ins.right);
+        for (n = 0; n < ins.right; ++n) {
+            if (operands[n] & SHARED) {
+                args.push_back(slots[operands[n] & ~SHARED]);
+            } else {
+                args.emplace_back(std::move(slots[operands[n]]));
+            }
+        }
+        return run(operands[-1], {fr.params, nullptr, args.data(), args.size(), nullptr});
+    }
+    case instruction::INVOKE:
+        return invoke(static_cast<operater::operater_code>(ins.oper), m_operands.data() + ins.left, ins.right, fr);
+    case instruction::OPERATE:
+        break;
+    case instruction::NUMBER:
+        return slots[ins.right].is_real() || slots[ins.right].is_complex() ? slots[ins.right] : none;
+    case instruction::NEGATIVE:
+        if (slots[ins.right].is_real()) {
+            return -slots[ins.right].real;
+        }
+        break;
+    default:
+        if (slots[ins.left].is_real() && slots[ins.right].is_real()) {
+            real_t left = slots[ins.left].real;
+            real_t right = slots[ins.right].real;
+            switch (ins.code) {
+            case instruction::PLUS:
+                return left + right;
+            case instruction::MINUS:
+                return left - right;
+            case instruction::MULTIPLY:
+                return left * right;
+            case instruction::DIVIDE:
+                if (0 != right) {
+                    return left / right;
+                }
+                break;
+            case instruction::POW:
+                if (0 <= left) {
+                    return pow(left, right);
+                }
+                break;
+            case instruction::LESS:
+                return left < right;
+            case instruction::LESS_EQUAL:
+                return left <= right;
+            case instruction::GREATER:
+                return left > right;
+            case instruction::GREATER_EQUAL:
+                return left >= right;
+            case instruction::EQUAL:
+                return left == right;
+            case instruction::NOT_EQUAL:
+                return left != right;
+            }
+        }
+        break;
+    }
+
+    return operate(NONE == ins.left ? none : slots[ins.left], operater_of(static_cast<operater::operater_code>(ins.oper)), NONE == ins.right ? none : slots[ins.right]);
+}
+
+variant program::invoke(operater::operater_code code, const uint32_t* items, size_t count, const frame& fr) const {
+    switch (code) {
+    case operater::GENERATE:
+        return invoke_generate(items, count, fr);
+    case operater::HAS:
+    case operater::PICK:
+    case operater::SELECT:
+    case operater::SORT:
+    case operater::TRANSFORM:
+    case operater::ACCUMULATE:
+        return invoke_sequence(code, items, count, fr);
+    case operater::SUMMATE:
+    case operater::PRODUCE:
+        return invoke_cumulate(code, items, count, fr);
+    case operater::INTEGRATE:
+        return invoke_integrate(items, count, fr);
+    case operater::DOUBLE_INTEGRATE:
+        return invoke_integrate2(items, count, fr);
+    case operater::TRIPLE_INTEGRATE:
+        return invoke_integrate3(items, count, fr);
+    }
+
+    return variant();
+}
+
+variant program::invoke_generate(const uint32_t* items, size_t count, const frame& fr) const {
+    if (count < 2) {
+        return variant();
+    }
+
+    const string_t& variables0 = m_routines[items[0]].variables;
+    variant arg0 = (variables0.empty() ? run(items[0], fr) : variant());
+
+    const string_t& variables1 = m_routines[items[1]].variables;
+    variant arg1 = (variables1.empty() ? run(items[1], fr) : variant());
+    size_t max_size = (arg1.is_valid() ? std::min(static_cast<size_t>(arg1.to_real()), MAX_GENERATE_SIZE) : MAX_GENERATE_SIZE);
+
+    variant res = sequence_t();
+    sequence_t& sequence = *res.sequence;
+    variant item;
+    const variant* locals[] = {&res, &item};
+    while (sequence.size() < max_size) {
+        item = (variables0.empty() ? arg0 : run_lambda(items[0], fr, locals));
+        if (!item.is_valid()) {
+            break;
+        }
+
+        if (!variables1.empty() && !run_lambda(items[1], fr, locals).to_boolean()) {
+            break;
+        }
+
+        sequence.emplace_back(std::move(item));
+    }
+
+    return res;
+}
+
+variant program::invoke_sequence(operater::operater_code code, const uint32_t* items, size_t count, const frame& fr) const {
+    if (count < 2) {
+        return variant();
+    }
+
+    variant arg0 = run(items[0], fr);
+    if (!arg0.is_sequence()) {
+        return variant();
+    }
+
+    const string_t& variables = m_routines[items[1]].variables;
+    variant arg1 = (variables.empty() ? run(items[1], fr) : variant());
+
+    const sequence_t& sequence = *arg0.sequence;
+    size_t size = sequence.size();
+    variant position;
+    const variant* locals[] = {nullptr, &position, &arg0};
+    auto bind = [&sequence, &position, &locals](size_t index) {
+        locals[0] = &sequence[index];
+        position = index;
+        return locals;
+    };
+
+    switch (code) {
+    case operater::HAS: {
+        if (variables.empty()) {
+            return sequence.end() != std::find(sequence.begin(), sequence.end(), arg1);
+        }
+
+        for (size_t index = 0; index < size; ++index) {
+            if (run_lambda(items[1], fr, bind(index)).to_boolean()) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+    case operater::PICK: {
+        variant arg2 = (3 <= count ? run(items[2], fr) : variant());
+        if (variables.empty()) {
+            real_t real = arg1.to_real();
+            size_t index = static_cast<size_t>(real < 0 ? size + real : real);
+            return index < size ? sequence[index] : arg2;
+        }
+
+        for (size_t index = 0; index < size; ++index) {
+            if (run_lambda(items[1], fr, bind(index)).to_boolean()) {
+                return sequence[index];
+            }
+        }
+
+        return arg2;
+    }
+    case operater::SELECT: {
+        sequence_t res;
+        for (size_t index = 0; index < size; ++index) {
+            if (variables.empty()) {
+                if (sequence[index] == arg1) {
+                    res.push_back(arg1);
+                }
+            } else {
+                if (run_lambda(items[1], fr, bind(index)).to_boolean()) {
+                    res.push_back(sequence[index]);
+                }
+            }
+        }
+
+        return res;
+    }
+    case operater::SORT: {
+        std::function<bool(const variant& var1, const variant& var2)> pred;
+        if (variables.size() < 2) {
+            operater oper = make_operater(arg1.to_boolean() ? operater::LESS : operater::GREATER);
+            pred = [oper](const variant& var1, const variant& var2) { return operate(var1, oper, var2).to_boolean(); };
+        } else {
+            pred = [this, items, &fr](const variant& var1, const variant& var2) {
+                const variant* pair[] = {&var1, &var2};
+                return run_lambda(items[1], fr, pair).to_boolean();
+            };
+        }
+
+        sequence_t res(sequence);
+        std::sort(res.begin(), res.end(), pred);
+        return res;
+    }
+    case operater::TRANSFORM: {
+        sequence_t res(size);
+        for (size_t index = 0; index < size; ++index) {
+            if (variables.empty()) {
+                res[index] = arg1;
+            } else {
+                res[index] = run_lambda(items[1], fr, bind(index));
+            }
+        }
+
+        return res;
+    }
+    case operater::ACCUMULATE: {
+        if (count < 3) {
+            return variant();
+        }
+
+        variant arg2 = run(items[2], fr);
+        if (!arg2.is_valid() || variables.size() < 2) {
+            return arg2;
+        }
+
+        const variant* accumulate[] = {&arg2, nullptr, &position, &arg0};
+        for (size_t index = 0; index < size; ++index) {
+            accumulate[1] = bind(index)[0];
+            arg2 = run_lambda(items[1], fr, accumulate);
+        }
+
+        return arg2;
+    }
+    }
+
+    return variant();
+}
+
+program::bound_t program::invoke_bound(uint32_t lower, uint32_t upper, const frame& fr, bool to_zahlen) const {
+    bound_t bound = {run(lower, fr).to_real(), run(upper, fr).to_real()};
+    if (bound.second < bound.first) {
+        std::swap(bound.first, bound.second);
+    }
+
+    if (to_zahlen) {
+        bound.first = trunc(bound.first);
+        bound.second = trunc(bound.second);
+    }
+
+    return bound;
+}
+
+variant program::invoke_cumulate(operater::operater_code code, const uint32_t* items, size_t count, const frame& fr) const {
+    if (count < 3 || m_routines[items[2]].variables.empty()) {
+        return variant();
+    }
+
+    variant res;
+    operater oper;
+    switch (code) {
+    case operater::SUMMATE:
+        res = real_t(0);
+        oper = make_operater(operater::PLUS);
+        break;
+    case operater::PRODUCE:
+        res = real_t(1);
+        oper = make_operater(operater::MULTIPLY);
+        break;
+    default:
+        return variant();
+    }
+
+    std::vector<double> params;
+    const native* nt = native_item(items[2], 1, fr, params);
+    bound_t bn = invoke_bound(items[0], items[1], fr, true);
+    variant var;
+    const variant* locals[] = {&var};
+    for (real_t n = bn.first; n <= bn.second; ++n) {
+        double value = (nt ? nt->function()(&n, params.data()) : NAN);
+        if (!std::isnan(value)) {
+            res = operate(res, oper, nt->value(value));
+        } else {
+            var = n;
+            res = operate(res, oper, run_lambda(items[2], fr, locals));
+        }
+    }
+
+    return res;
+}
+
+variant program::invoke_integrate(const uint32_t* items, size_t count, const frame& fr) const {
+    if (count < 3 || m_routines[items[2]].variables.empty()) {
+        return variant();
+    }
+
+    bound_t bx = invoke_bound(items[0], items[1], fr);
+    real_t dx = (bx.second - bx.first) / INTEGRATE_PIECE_SIZE;
+
+    std::vector<double> params;
+    const native* nt = native_item(items[2], 1, fr, params);
+    auto integrand = [this, items, &fr, nt, &params](real_t x) {
+        double value = (nt ? nt->function()(&x, params.data()) : NAN);
+        if (!std::isnan(value)) {
+            return value;
+        }
+
+        variant var = x;
+        const variant* locals[] = {&var};
+        return run_lambda(items[2], fr, locals).to_real();
+    };
+
+    real_t res = (integrand(bx.first) + integrand(bx.second)) * 0.5;
+    for (size_t n = 1; n < INTEGRATE_PIECE_SIZE; ++n) {
+        res += integrand(bx.first + dx * n);
+    }
+
+    return res * dx;
+}
+
+variant program::invoke_integrate2(const uint32_t* items, size_t count, const frame& fr) const {
+    if (count < 5) {
+        return variant();
+    }
+
+    const string_t& variables = m_routines[items[4]].variables;
+    if (variables.size() < 2) {
+        return variant();
+    }
+
+    bound_t by = invoke_bound(items[0], items[1], fr);
+    real_t dy = (by.second - by.first) / INTEGRATE2_PIECE_SIZE;
+
+    bound_t bx = invoke_bound(items[2], items[3], fr);
+    real_t dx = (bx.second - bx.first) / INTEGRATE2_PIECE_SIZE;
+
+    std::vector<double> params;
+    const native* nt = native_item(items[4], 2, fr, params);
+    auto integrand = [this, items, &fr, nt, &params](real_t x, real_t y) {
+        double vars[] = {x, y};
+        double value = (nt ? nt->function()(vars, params.data()) : NAN);
+        if (!std::isnan(value)) {
+            return value;
+        }
+
+        variant values[] = {x, y};
+        const variant* locals[] = {&values[0], &values[1]};
+        return run_lambda(items[4], fr, locals).to_real();
+    };
+
+    auto adjust = [](real_t& value, size_t n) {
+        if (0 == n || INTEGRATE2_PIECE_SIZE == n) {
+            value *= 0.5;
+        }
+    };
+
+    real_t res = 0;
+    for (size_t ny = 0; ny <= INTEGRATE2_PIECE_SIZE; ++ny) {
+        real_t y = by.first + dy * ny;
+        for (size_t nx = 0; nx <= INTEGRATE2_PIECE_SIZE; ++nx) {
+            real_t value = integrand(bx.first + dx * nx, y);
+            adjust(value, nx);
+            adjust(value, ny);
+            res += value;
+        }
+    }
+
+    return res * dx * dy;
+}
+
+variant program::invoke_integrate3(const uint32_t* items, size_t count, const frame& fr) const {
+    if (count < 7) {
+        return variant();
+    }
+
+    const string_t& variables = m_routines[items[6]].variables;
+    if (variables.size() < 3) {
+        return variant();
+    }
+
+    bound_t bz = invoke_bound(items[0], items[1], fr);
+    real_t dz = (bz.second - bz.first) / INTEGRATE3_PIECE_SIZE;
+
+    bound_t by = invoke_bound(items[2], items[3], fr);
+    real_t dy = (by.second - by.first) / INTEGRATE3_PIECE_SIZE;
+
+    bound_t bx = invoke_bound(items[4], items[5], fr);
+    real_t dx = (bx.second - bx.first) / INTEGRATE3_PIECE_SIZE;
+
+    std::vector<double> params;
+    const native* nt = native_item(items[6], 3, fr, params);
+    auto integrand = [this, items, &fr, nt, &params](real_t x, real_t y, real_t z) {
+        double vars[] = {x, y, z};
+        double value = (nt ? nt->function()(vars, params.data()) : NAN);
+        if (!std::isnan(value)) {
+            return value;
+        }
+
+        variant values[] = {x, y, z};
+        const variant* locals[] = {&values[0], &values[1], &values[2]};
+        return run_lambda(items[6], fr, locals).to_real();
+    };
+
+    auto adjust = [](real_t& value, size_t n) {
+        if (0 == n || INTEGRATE3_PIECE_SIZE == n) {
+            value *= 0.5;
+        }
+    };
+
+    real_t res = 0;
+    for (size_t nz = 0; nz <= INTEGRATE3_PIECE_SIZE; ++nz) {
+        real_t z = bz.first + dz * nz;
+        for (size_t ny = 0; ny <= INTEGRATE3_PIECE_SIZE; ++ny) {
+            real_t y = by.first + dy * ny;
+            for (size_t nx = 0; nx <= INTEGRATE3_PIECE_SIZE; ++nx) {
+                real_t value = integrand(bx.first + dx * nx, y, z);
+                adjust(value, nx);
+                adjust(value, ny);
+                adjust(value, nz);
+                res += value;
+            }
+        }
+    }
+
+    return res * dx * dy * dz;
+}
+
+}
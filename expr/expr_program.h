@@ -0,0 +1,177 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef EXPR_PROGRAM_H
+#define EXPR_PROGRAM_H
+
+#include <cstdint>
+#include "expr_handler.h"
+#include "expr_native.h"
+
+namespace expr {
+
+// post-order form of a tree, routine 0 is the root
+class program {
+public:
+    using calc_assist = handler::calc_assist;
+
+    struct instruction {
+        enum instruction_code : uint8_t {
+            CONSTANT,       // left: constant
+            PARAM,          // left: position in params
+            VARIABLE,       // left: variable, resolved by the replacer
+            LOCAL,          // left: position in the values bound by the invocation running the item
+            ARGUMENT,       // left: position in the arguments of the running rule
+            ARRAY,          // left: first operand, right: count of operands, both slots, maybe SHARED
+            REALS,          // oper, left: packed reals
+            CALL,           // left: rule routine, then argument slots, right: count of arguments
+            INVOKE,         // oper, left: first operand, right: count of operands, both routines
+            OPERATE,        // oper, left and right: slots or NONE
+
+            // OPERATE specialized by operator
+            PLUS,
+            MINUS,
+            MULTIPLY,
+            DIVIDE,
+            POW,
+            NEGATIVE,       // right only
+            LESS,
+            LESS_EQUAL,
+            GREATER,
+            GREATER_EQUAL,
+            EQUAL,
+            NOT_EQUAL,
+
+            NUMBER          // oper: REAL, right: slot, non-numbers give nothing
+        };
+
+        instruction_code    code;
+        uint16_t            oper;
+        uint32_t            left;
+        uint32_t            right;
+
+        bool is_operate() const {
+            return OPERATE <= code;
+        }
+    };
+
+    struct routine {
+        uint32_t            begin;
+        uint32_t            end;
+        string_t            variables;
+    };
+
+    struct reduction {
+        size_t squares = 0;             // x^2 to x*x
+        size_t cubes = 0;               // x^3 to x*x*x
+        size_t reciprocals = 0;         // x/c to x*(1/c), 1/c a power of two
+        size_t inexact_reciprocals = 0; // x/c to x*(1/c), 1/c rounded
+        size_t exp_lns = 0;             // exp(ln(x)) to x
+        size_t sqrt_squares = 0;        // √(x)^2 to x
+        size_t multiply_ones = 0;       // x*1 and 1*x to x
+        size_t plus_zeros = 0;          // x+0, 0+x and x-0 to x
+        size_t double_negatives = 0;    // --x to x
+    };
+
+    enum value_type : uint8_t {
+        ANY,
+        BOOLEAN,
+        REAL,
+        COMPLEX
+    };
+
+    static const uint32_t NONE = UINT32_MAX;
+    // slot read more than once, copied instead of moved
+    static const uint32_t SHARED = 0x80000000;
+
+public:
+    program() = default;
+    explicit program(const node* root);
+
+public:
+    // reentrant
+    variant calc(const calc_assist& assist = calc_assist()) const;
+    size_t eliminate_common();
+    size_t fold_constants();
+    // inexact also turns x/c into x*(1/c) for reciprocals that round
+    reduction reduce_strength(bool inexact = false);
+    size_t compile_native();
+    size_t infer_types();
+    native_ptr native_code(uint32_t routine) const;
+    size_t size() const;
+    const std::vector<instruction>& code() const;
+    const std::vector<routine>& routines() const;
+    const std::vector<symbol_t>& params() const;
+    const std::vector<value_type>& types() const;
+    bool typed(uint32_t routine) const;
+
+private:
+    friend class native;
+    struct frame;
+    struct builder;
+    struct scalar;
+    struct bindings;
+    using bound_t = std::pair<real_t, real_t>;
+    using rewriter = std::function<uint32_t(const instruction& ins, std::vector<instruction>& body, std::vector<uint32_t>& items)>;
+
+    void compile(builder& bd, const node* root, bool arguments, const string_t& parameters, size_t bound);
+    uint32_t add_routine(builder& bd, const node* root, bool arguments, const string_t& parameters, const string_t& variables, size_t bound);
+    uint32_t add_constant(const variant& value);
+    std::vector<bool> impure_routines() const;
+    std::vector<uint32_t> common_constants() const;
+    instruction remap(instruction ins, const std::vector<uint32_t>& slot_of, std::vector<uint32_t>& items) const;
+    size_t rewrite(const rewriter& rw);
+    void share_slots(uint32_t index);
+    const native* native_item(uint32_t index, size_t bound, const frame& fr, std::vector<double>& params) const;
+
+    const variant& param(uint32_t index, const frame& fr) const;
+    variant run(uint32_t index, const frame& fr) const;
+    bool run_typed(uint32_t index, const frame& fr, const scalar* caller, const uint32_t* operands, size_t count, scalar& res) const;
+    bool operate_typed(const instruction& ins, const value_type* types, const scalar* slots, value_type type, scalar& res) const;
+    variant run_lambda(uint32_t index, const frame& fr, const variant* const* locals) const;
+    variant execute(const instruction& ins, variant* slots, const frame& fr) const;
+    variant invoke(operater::operater_code code, const uint32_t* items, size_t count, const frame& fr) const;
+    variant invoke_generate(const uint32_t* items, size_t count, const frame& fr) const;
+    variant invoke_sequence(operater::operater_code code, const uint32_t* items, size_t count, const frame& fr) const;
+    bound_t invoke_bound(uint32_t lower, uint32_t upper, const frame& fr, bool to_zahlen = false) const;
+    variant invoke_cumulate(operater::operater_code code, const uint32_t* items, size_t count, const frame& fr) const;
+    variant invoke_integrate(const uint32_t* items, size_t count, const frame& fr) const;
+    variant invoke_integrate2(const uint32_t* items, size_t count, const frame& fr) const;
+    variant invoke_integrate3(const uint32_t* items, size_t count, const frame& fr) const;
+
+private:
+    std::vector<instruction> m_code;
+    std::vector<routine> m_routines;
+    std::vector<uint32_t> m_operands;
+    std::vector<variant> m_constants;
+    std::vector<real_array> m_reals;
+    std::vector<symbol_t> m_params;
+    std::vector<native_ptr> m_natives;
+    std::vector<value_type> m_types;
+    std::vector<bool> m_typed;
+};
+
+}
+
+#endif
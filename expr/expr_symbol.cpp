@@ -0,0 +1,86 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "expr_symbol.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace expr {
+
+const size_t SYMBOL_BLOCK_SIZE  = 4096;
+const size_t MAX_SYMBOL_BLOCKS  = 16384;
+
+static std::atomic<string_t*> s_blocks[MAX_SYMBOL_BLOCKS];
+static std::atomic<size_t> s_count(0);
+
+using symbol_map = std::unordered_map<std::reference_wrapper<const string_t>, symbol_t, std::hash<string_t>, std::equal_to<string_t>>;
+
+static std::mutex& symbol_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+static symbol_map& symbols() {
+    static symbol_map map;
+    return map;
+}
+
+symbol_t intern(const string_t& str) {
+    std::lock_guard<std::mutex> lock(symbol_mutex());
+    symbol_map& map = symbols();
+    auto iter = map.find(std::cref(str));
+    if (map.end() != iter) {
+        return iter->second;
+    }
+
+    size_t count = s_count.load(std::memory_order_relaxed);
+    size_t block = count / SYMBOL_BLOCK_SIZE;
+    if (MAX_SYMBOL_BLOCKS <= block) {
+        return NO_SYMBOL;
+    }
+
+    string_t* strings = s_blocks[block].load(std::memory_order_relaxed);
+    if (!strings) {
+        strings = new string_t[SYMBOL_BLOCK_SIZE];
+        s_blocks[block].store(strings, std::memory_order_release);
+    }
+
+    string_t& slot = strings[count % SYMBOL_BLOCK_SIZE];
+    slot = str;
+    symbol_t symbol = static_cast<symbol_t>(count);
+    map.emplace(std::cref(slot), symbol);
+    s_count.store(count + 1, std::memory_order_release);
+    return symbol;
+}
+
+const string_t& symbol_name(symbol_t symbol) {
+    return s_blocks[symbol / SYMBOL_BLOCK_SIZE].load(std::memory_order_acquire)[symbol % SYMBOL_BLOCK_SIZE];
+}
+
+size_t symbol_count() {
+    return s_count.load(std::memory_order_acquire);
+}
+
+}
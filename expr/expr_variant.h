@@ -28,6 +28,7 @@
 #include <cstring>
 #include <algorithm>
 #include "expr_common.h"
+#include "expr_pool.h"
 
 namespace expr {
 
@@ -57,10 +58,10 @@ struct variant {
     variant(real_t value) : type(REAL), real(value) {}
     variant(size_t value) : type(REAL), real(real_t(value)) {}
     variant(int value) : type(REAL), real(real_t(value)) {}
-    variant(const complex_t& value) : type(COMPLEX), complex(new complex_t(value)) {}
-    variant(const string_t& value) : type(STRING), string(new string_t(value)) {}
-    variant(const char_t* value) : type(STRING), string(new string_t(value)) {}
-    variant(const sequence_t& value) : type(SEQUENCE), sequence(new sequence_t(value)) {}
+    variant(const complex_t& value) : type(COMPLEX), complex(make_payload<complex_t>(value)) {}
+    variant(const string_t& value) : type(STRING), string(make_payload<string_t>(value)) {}
+    variant(const char_t* value) : type(STRING), string(make_payload<string_t>(value)) {}
+    variant(const sequence_t& value) : type(SEQUENCE), sequence(make_payload<sequence_t>(value)) {}
 
     variant(const variant& other) {
         copy(other);
@@ -95,13 +96,13 @@ struct variant {
     void clear() {
         switch (type) {
         case COMPLEX:
-            delete complex;
+            free_payload(complex);
             break;
         case STRING:
-            delete string;
+            free_payload(string);
             break;
         case SEQUENCE:
-            delete sequence;
+            free_payload(sequence);
             break;
         }
 
@@ -208,13 +209,13 @@ private:
         memcpy(this, &other, sizeof(variant));
         switch (type) {
         case COMPLEX:
-            complex = new complex_t(*other.complex);
+            complex = make_payload<complex_t>(*other.complex);
             break;
         case STRING:
-            string = new string_t(*other.string);
+            string = make_payload<string_t>(*other.string);
             break;
         case SEQUENCE:
-            sequence = new sequence_t(*other.sequence);
+            sequence = make_payload<sequence_t>(*other.sequence);
             break;
         }
     }
@@ -1,7 +1,9 @@
 #!/bin/bash
 
 # include source files in extradefs.depend
-# add comment "extradefs(scope::enum)" to enums
+# add comment "extradefs(scope::enum) // field1 // field2 ..." to enums
+# values are listed in the same order after each enumerator,
+# columns holding only integers become int fields, the others become string literals
 
 # param1: dest_path
 
@@ -24,20 +26,104 @@ function handle_enums() {
         [[ $enum = $scope ]] && scope="" || scope=$scope::
 
         local enum_decl="enum\s+(class\s+)?$enum"
-        local code=$(grep $grep_span "$enum_decl\s*{[^}]+};" $1 | tr -d "\r\0" | sed "s#%#%%#g")
+        local code=$(grep $grep_span "$enum_decl\s*{[^}]+};" $1 | tr -d "\r\0")
         local scope_self=""
-        [[ -n $(printf "$code" | grep -Eo "^enum\s+class\s+") ]] && scope_self=$enum::
+        [[ -n $(printf "%s" "$code" | grep -Eo "^enum\s+class\s+") ]] && scope_self=$enum::
+
+        local fields=$(grep -F "extradefs($param)" $1 | tr -d "\r" | sed -r "s#.*extradefs\([^)]+\)##")
 
         printf "\n\n" >> $dest_path
 
-        printf "$code" |
-            sed -r "s#^$enum_decl#const extra_map<$scope$enum> EXTRA_${enum^^} =#;
-                    s#^\s*##;
-                    s#\s*\$##;
-                    s#^//#@@#;
-                    s#^([A-Za-z0-9_]+)\s*(,?)\s*//\s*(.*)#    {$scope$scope_self\1, {EXTRA_STR(\"\3\")\}\}\2#;
-                    s#\s*//\s*#\"), EXTRA_STR(\"#g;
-                    s#^@@#    //#" >> $dest_path
+        printf "%s\n" "$code" | awk -v enum="$enum" -v key="$scope$enum" -v prefix="$scope$scope_self" -v fields="$fields" '
+            function trim(s) {
+                sub(/^[ \t]+/, "", s)
+                sub(/[ \t]+$/, "", s)
+                return s
+            }
+
+            function literal(s) {
+                gsub(/\\/, "\\\\", s)
+                gsub(/"/, "\\\"", s)
+                return "EXTRA_STR(\"" s "\")"
+            }
+
+            BEGIN {
+                field_count = split(fields, names, /[ \t]*\/\/[ \t]*/)
+                for (n = 1; n < field_count; ++n) {
+                    names[n] = trim(names[n + 1])
+                    integral[n] = 1
+                }
+                --field_count
+            }
+
+            NR == 1 || /^[ \t]*}/ {
+                next
+            }
+
+            {
+                line = trim($0)
+                if (line == "" || line ~ /^\/\//) {
+                    lines[++line_count] = line
+                    next
+                }
+
+                name = line
+                sub(/[ \t]*,?[ \t]*(\/\/.*)?$/, "", name)
+                values = ""
+                if (match(line, /\/\//)) {
+                    values = substr(line, RSTART + 2)
+                }
+
+                lines[++line_count] = ""
+                rows[line_count] = name
+                value_count = split(values, items, /[ \t]*\/\/[ \t]*/)
+                for (n = 1; n <= field_count; ++n) {
+                    value = n <= value_count ? trim(items[n]) : ""
+                    cells[line_count, n] = value
+                    if (value != "" && value !~ /^-?[0-9]+$/) {
+                        integral[n] = 0
+                    }
+                }
+            }
+
+            END {
+                record = "extra_" enum
+                table = "EXTRA_" toupper(enum)
+
+                print "struct " record " {"
+                print "    " key " key;"
+                for (n = 1; n <= field_count; ++n) {
+                    print "    " (integral[n] ? "int " : "const EXTRA_CHAR_T* ") names[n] ";"
+                }
+                print "};"
+                print ""
+                print "constexpr " record " " table "[] = {"
+
+                last = 0
+                for (l = 1; l <= line_count; ++l) {
+                    if (l in rows) {
+                        last = l
+                    }
+                }
+
+                for (l = 1; l <= line_count; ++l) {
+                    if (!(l in rows)) {
+                        print (lines[l] == "" ? "" : "    " lines[l])
+                        continue
+                    }
+
+                    row = "    {" prefix rows[l]
+                    for (n = 1; n <= field_count; ++n) {
+                        value = cells[l, n]
+                        row = row ", " (integral[n] ? (value == "" ? "0" : value) : literal(value))
+                    }
+                    print row "}" (l == last ? "" : ",")
+                }
+
+                print "};"
+                print ""
+                printf "static_assert(extra_indexed(%s, extra_size(%s)), \"%s must be ordered by key\");", table, table, table
+            }' >> $dest_path
     done
 
     printf "\n\n#endif\n#endif" >> $dest_path
@@ -46,41 +132,20 @@ function handle_enums() {
 printf "\
 #ifndef EXTRADEFS_H\n\
 #define EXTRADEFS_H\n\n\
-#include <string>\n\
-#include <vector>\n\
-#include <map>\n\n\
-#define EXTRA_STRING_T std::wstring\n\
+#include <cstddef>\n\n\
+#define EXTRA_CHAR_T wchar_t\n\
 #define EXTRA_STR(s) L##s\n\n\
-class extra_vector : public std::vector<EXTRA_STRING_T> {\n\
-public:\n\
-    using std::vector<EXTRA_STRING_T>::vector;\n\n\
-    inline EXTRA_STRING_T string(size_t pos) const {\n\
-        EXTRA_STRING_T str;\n\
-        try { str = this->at(pos); } catch (...) {}\n\
-        return str;\n\
-    }\n\n\
-    inline int integer(size_t pos) const {\n\
-        int num = 0;\n\
-        try { num = std::stoi(string(pos)); } catch (...) {}\n\
-        return num;\n\
-    }\n\
-};\n\n\
-template<class key_t>\n\
-class extra_map : public std::map<key_t, extra_vector> {\n\
-public:\n\
-    using std::map<key_t, extra_vector>::map;\n\n\
-    inline EXTRA_STRING_T string(key_t key, size_t pos) const {\n\
-        auto iter = this->find(key);\n\
-        return this->end() != iter ? iter->second.string(pos) : EXTRA_STRING_T();\n\
-    }\n\n\
-    inline int integer(key_t key, size_t pos) const {\n\
-        auto iter = this->find(key);\n\
-        return this->end() != iter ? iter->second.integer(pos) : 0;\n\
-    }\n\
-};\n\n\
+template<class record_t, size_t size>\n\
+constexpr size_t extra_size(const record_t (&)[size]) {\n\
+    return size;\n\
+}\n\n\
+template<class record_t>\n\
+constexpr bool extra_indexed(const record_t* records, size_t size, size_t pos = 0) {\n\
+    return pos == size || (static_cast<size_t>(records[pos].key) == pos && extra_indexed(records, size, pos + 1));\n\
+}\n\n\
 #endif" > $dest_path
 
 for line in $(cat $current_dir/extradefs.depend | tr -d "\r\0"); do
     source_path=$current_dir/$line
-    handle_enums $source_path $(sed -nr "s#.*extradefs\((.+)\).*#\1#p" $source_path)
+    handle_enums $source_path $(sed -nr "s#.*extradefs\(([^)]+)\).*#\1#p" $source_path)
 done
@@ -0,0 +1,361 @@
+/*
+  MIT License
+
+  Copyright (c) 2025 Kong Pengsheng
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <thread>
+#include "expr_batch.h"
+#include "expr_program.h"
+
+std::atomic<size_t> g_allocations(0);
+std::atomic<size_t> g_live_bytes(0);
+std::atomic<size_t> g_peak_bytes(0);
+const size_t ALLOCATION_HEADER = 16;
+
+void* operator new(size_t size) {
+    char* ptr = static_cast<char*>(std::malloc(size + ALLOCATION_HEADER));
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+
+    *reinterpret_cast<size_t*>(ptr) = size;
+    ++g_allocations;
+    size_t live = g_live_bytes += size;
+    size_t peak = g_peak_bytes;
+    while (peak < live && !g_peak_bytes.compare_exchange_weak(peak, live));
+    return ptr + ALLOCATION_HEADER;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr) {
+        char* base = static_cast<char*>(ptr) - ALLOCATION_HEADER;
+        g_live_bytes -= *reinterpret_cast<size_t*>(base);
+        std::free(base);
+    }
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+using shape_builder = std::string (*)(size_t size);
+
+std::string flat_sum(size_t size) {
+    std::string expr = "1";
+    for (size_t i = 1; i < size; ++i) {
+        expr += "+1";
+    }
+    return expr;
+}
+
+std::string nested_parens(size_t size) {
+    return std::string(size, '(') + "1" + std::string(size, ')');
+}
+
+std::string array_items(size_t size) {
+    std::string expr = "sum(1";
+    for (size_t i = 1; i < size; ++i) {
+        expr += ",1";
+    }
+    return expr + ")";
+}
+
+std::string numeric_mean(size_t size) {
+    std::string expr = "mean(1.5";
+    for (size_t i = 1; i < size; ++i) {
+        expr += ",2.25";
+    }
+    return expr + ")";
+}
+
+void bench(const char* name, shape_builder builder, size_t size, bool calc = false) {
+    std::string expr = builder(size);
+    std::string blob = expr::handler(expr).save();
+    size_t allocations = g_allocations;
+    g_peak_bytes = g_live_bytes.load();
+    size_t base_bytes = g_live_bytes;
+    auto begin = std::chrono::steady_clock::now();
+    bool valid = false;
+    double calc_ms = 0;
+    {
+        expr::handler hdl(expr);
+        valid = hdl.is_valid();
+        if (valid && calc) {
+            auto calc_begin = std::chrono::steady_clock::now();
+            hdl.calc();
+            calc_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - calc_begin).count();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - begin).count() - calc_ms;
+    allocations = g_allocations - allocations;
+    size_t peak_kb = (g_peak_bytes - base_bytes) / 1024;
+
+    begin = std::chrono::steady_clock::now();
+    {
+        expr::handler hdl = expr::handler::load(blob.data(), blob.size());
+    }
+    end = std::chrono::steady_clock::now();
+    double load_ms = std::chrono::duration<double, std::milli>(end - begin).count();
+
+    std::cout << name << "\t" << size << "\t" << (valid ? "valid" : "invalid") << "\t" << ms << " ms\t" << allocations << " allocs\t" << peak_kb << " kb peak\tload " << load_ms << " ms";
+    if (calc) {
+        std::cout << "\tcalc " << calc_ms << " ms";
+    }
+    std::cout << std::endl;
+}
+
+void bench_calc(const char* name, const char* source) {
+    expr::handler hdl(source);
+    auto begin = std::chrono::steady_clock::now();
+    expr::variant res = hdl.calc();
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::cout << name << "\t" << expr::to_utf8(res.to_text()) << "\t" << ms << " ms" << std::endl;
+}
+
+void bench_common(const char* name, const char* source) {
+    expr::handler hdl(source);
+    expr::program pg = *hdl.compile();
+    size_t size = pg.size();
+    size_t eliminated = pg.eliminate_common();
+
+    auto begin = std::chrono::steady_clock::now();
+    hdl.calc();
+    auto middle = std::chrono::steady_clock::now();
+    pg.calc();
+    auto end = std::chrono::steady_clock::now();
+    double plain_ms = std::chrono::duration<double, std::milli>(middle - begin).count();
+    double common_ms = std::chrono::duration<double, std::milli>(end - middle).count();
+    std::cout << name << "\t" << size << " - " << eliminated << " instructions\t" << plain_ms << " ms\tcommon " << common_ms << " ms" << std::endl;
+}
+
+void bench_native(const char* name, const char* source) {
+    expr::handler hdl(source);
+    expr::handler optimized(hdl);
+    optimized.optimize(expr::handler::NATIVE);
+    expr::program_ptr pg = optimized.compile();
+    size_t compiled = 0;
+    for (uint32_t index = 0; index < pg->routines().size(); ++index) {
+        compiled += (nullptr != pg->native_code(index));
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    hdl.calc();
+    auto middle = std::chrono::steady_clock::now();
+    expr::variant res = optimized.calc();
+    auto end = std::chrono::steady_clock::now();
+    double plain_ms = std::chrono::duration<double, std::milli>(middle - begin).count();
+    double native_ms = std::chrono::duration<double, std::milli>(end - middle).count();
+    std::cout << name << "\t" << expr::to_utf8(res.to_text()) << "\t" << compiled << " native\t" << plain_ms << " ms\tnative " << native_ms << " ms" << std::endl;
+}
+
+void bench_reduce(const char* name, const char* source) {
+    expr::handler hdl(source);
+    expr::program pg = *hdl.compile();
+    expr::program::reduction rd = pg.reduce_strength();
+
+    auto begin = std::chrono::steady_clock::now();
+    hdl.calc();
+    auto middle = std::chrono::steady_clock::now();
+    expr::variant res = pg.calc();
+    auto end = std::chrono::steady_clock::now();
+    double plain_ms = std::chrono::duration<double, std::milli>(middle - begin).count();
+    double reduced_ms = std::chrono::duration<double, std::milli>(end - middle).count();
+    std::cout << name << "\t" << expr::to_utf8(res.to_text()) << "\tsquares " << rd.squares << " cubes " << rd.cubes
+              << " reciprocals " << rd.reciprocals << " inexact_reciprocals " << rd.inexact_reciprocals << " exp_lns "
+              << rd.exp_lns << " sqrt_squares " << rd.sqrt_squares << " multiply_ones " << rd.multiply_ones << " plus_zeros "
+              << rd.plus_zeros << " double_negatives " << rd.double_negatives << "\t" << plain_ms << " ms\treduced " << reduced_ms << " ms" << std::endl;
+}
+
+void bench_typed(const char* name, const char* source) {
+    expr::handler hdl(source);
+    expr::program pg = *hdl.compile();
+    size_t typed = pg.infer_types();
+
+    auto begin = std::chrono::steady_clock::now();
+    hdl.calc();
+    auto middle = std::chrono::steady_clock::now();
+    expr::variant res = pg.calc();
+    auto end = std::chrono::steady_clock::now();
+    double plain_ms = std::chrono::duration<double, std::milli>(middle - begin).count();
+    double typed_ms = std::chrono::duration<double, std::milli>(end - middle).count();
+    std::cout << name << "\t" << expr::to_utf8(res.to_text()) << "\t" << typed << " typed\t" << plain_ms << " ms\ttyped " << typed_ms << " ms" << std::endl;
+}
+
+void bench_params(const char* name, const char* source) {
+    expr::handler hdl(source);
+    std::map<expr::string_t, expr::real_t> table;
+    std::mutex mutex;
+    size_t calls = 0;
+    expr::handler::calc_assist assist;
+    assist.pr = [&](const expr::string_t& param) -> expr::variant {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++calls;
+        return table[param] = expr::real_t(param.size());
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    expr::variant res = hdl.calc(assist);
+    auto middle = std::chrono::steady_clock::now();
+    std::vector<expr::real_t> reals;
+    for (const expr::string_t& param : hdl.params()) {
+        reals.push_back(table[param]);
+    }
+    expr::handler::calc_assist bound;
+    bound.reals = reals.data();
+    bound.count = reals.size();
+    hdl.calc(bound);
+    auto end = std::chrono::steady_clock::now();
+    double replaced_ms = std::chrono::duration<double, std::milli>(middle - begin).count();
+    double bound_ms = std::chrono::duration<double, std::milli>(end - middle).count();
+    std::cout << name << "\t" << expr::to_utf8(res.to_text()) << "\t" << reals.size() << " params\t" << calls << " calls\t" << replaced_ms << " ms\tbound " << bound_ms << " ms" << std::endl;
+}
+
+void bench_batch(size_t count, size_t threads) {
+    std::vector<std::string> sources(count);
+    for (size_t i = 0; i < count; ++i) {
+        sources[i] = "{f(x)=x^2+" + std::to_string(i) + "}f(3)*mean(1,2," + std::to_string(i) + ")-sin(pi/" + std::to_string(i + 1) + ")";
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<expr::handler> handlers = expr::parse_all(sources.data(), sources.size(), threads);
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::cout << "parse_all\t" << count << "\t" << (threads ? std::to_string(threads) : std::string("all")) << " threads\t" << ms << " ms" << std::endl;
+}
+
+void bench_shared(const char* source, size_t count, size_t threads) {
+    expr::handler hdl(std::string(source), nullptr);
+    hdl.calc();
+
+    size_t workers = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (size_t i = 0; i < workers; ++i) {
+        pool.emplace_back([&hdl, count]() {
+            for (size_t j = 0; j < count; ++j) {
+                hdl.calc();
+            }
+        });
+    }
+    for (std::thread& t : pool) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::cout << "shared_calc\t" << count * workers << "\t" << (threads ? std::to_string(threads) : std::string("all")) << " threads\t" << ms << " ms" << std::endl;
+}
+
+// results of calc from several threads must match one thread
+bool check_shared(const char* source, size_t threads, size_t rounds) {
+    bool passed = true;
+    for (expr::handler::optimize_level level : {expr::handler::FOLD, expr::handler::REDUCE, expr::handler::TYPED, expr::handler::NATIVE}) {
+        expr::handler reference(std::string(source), nullptr);
+        reference.optimize(level);
+        expr::string_array names = reference.params();
+        auto calc = [&names](const expr::handler& hdl, size_t thread) {
+            std::vector<expr::real_t> reals;
+            for (size_t i = 0; i < names.size(); ++i) {
+                reals.push_back(thread + 1 + i * 0.5);
+            }
+            expr::handler::calc_assist assist([&names, &reals](const expr::string_t& param) {
+                return expr::variant(reals[std::find(names.begin(), names.end(), param) - names.begin()]);
+            });
+            if (0 == thread % 2) {
+                assist.reals = reals.data();
+                assist.count = reals.size();
+            }
+            return expr::to_utf8(hdl.calc(assist).to_text());
+        };
+
+        std::vector<std::string> expected(threads);
+        for (size_t thread = 0; thread < threads; ++thread) {
+            expected[thread] = calc(reference, thread);
+        }
+
+        expr::handler hdl(std::string(source), nullptr);
+        hdl.optimize(level);
+        std::atomic<size_t> mismatches(0);
+        std::vector<std::thread> pool;
+        for (size_t thread = 0; thread < threads; ++thread) {
+            pool.emplace_back([&, thread]() {
+                expr::handler copy(hdl);
+                const expr::handler& used = (thread / 2 % 2 ? copy : hdl);
+                for (size_t round = 0; round < rounds; ++round) {
+                    if (calc(used, thread) != expected[thread]) {
+                        ++mismatches;
+                    }
+                }
+            });
+        }
+        for (std::thread& t : pool) {
+            t.join();
+        }
+
+        std::cout << "shared_check\t" << source << "\tlevel " << static_cast<int>(level) << "\t" << mismatches << " mismatches" << std::endl;
+        passed = passed && !mismatches;
+    }
+
+    return passed;
+}
+
+int main(int argc, char* argv[]) {
+    bool passed = check_shared("{f(x)=x*[rate]+[offset]^2}sum(1,100,f(x))", 8, 4);
+    passed = check_shared("{f(x)=abs((x+[rate]*i)/(x+2i))+√(x)*x}sum(1,100,f(x))", 8, 4) && passed;
+    passed = check_shared("(med([a],3,1)+cnt(\"x\"+\"y\")*[b],[a]/[b],√(-[a]))", 8, 4) && passed;
+    passed = check_shared("{f(x)=x^2*[rate]-1}int(0,1,f(x))", 2, 1) && passed;
+    size_t limit = 1 < argc ? std::stoul(argv[1]) : 1000000;
+    for (size_t size = 1000; size <= limit; size *= 10) {
+        bench("flat_sum", flat_sum, size, true);
+        bench("nested_parens", nested_parens, size);
+        bench("array_items", array_items, size);
+        bench("numeric_mean", numeric_mean, size, true);
+    }
+
+    bench_calc("integrate", "{f(x)=x^2+sin(x)*x-1}int(0,1,f(x))");
+    bench_calc("summate", "{f(x)=x*(x+1)*(x+2)/(x+4)}sum(1,100000,f(x))");
+    bench_calc("complex", "{f(x)=abs((x+i)*(x-i)/(x+2i))+cnt(\"a\"+\"b\")}sum(1,100000,f(x))");
+    bench_native("native", "{f(x,y)=x*y+x^2-√(y+1)}∫∫(0,1,0,2,f(x,y))");
+    bench_reduce("reduce", "{f(x)=exp(ln(x+1))*x^2/3-x^3*1+√(x)^2}∫(0,1,f(x))");
+    bench_typed("typed", "{f(x)=abs((x+i)*(x-i)/(x+2i))+√(x)*x}sum(1,100000,f(x))");
+    bench_params("params", "{f(x)=x*[rate]+[offset]^2}int(0,1,f(x))");
+    bench_common("common", "{f(x)=rt(x^2+1)+rt(x^2+1)*2-rt(x^2+1)/(rt(x^2+1)+1)}int(0,1,f(x))");
+
+    for (size_t threads : {1, 2, 4, 0}) {
+        bench_batch(200000, threads);
+    }
+
+    for (size_t threads : {1, 2, 4, 0}) {
+        bench_shared("{f(x)=x*(x+1)/(x+2)}sum(1,1000,f(x))", 2000, threads);
+    }
+
+    return passed ? 0 : 1;
+}
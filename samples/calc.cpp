@@ -25,7 +25,7 @@
 #include <iostream>
 #include "expr_handler.h"
 
-void handle(const expr::string_t& expr) {
+void handle(const std::string& expr) {
     expr::handler hdl(expr);
     size_t failed_pos = 0;
     bool valid = hdl.is_valid(&failed_pos);
@@ -43,7 +43,7 @@ void handle(const expr::string_t& expr) {
 
 int main(int argc, char* argv[]) {
     if (1 < argc) {
-        handle(expr::from_utf8(argv[1]));
+        handle(argv[1]);
         return 0;
     }
 
@@ -54,7 +54,7 @@ int main(int argc, char* argv[]) {
             break;
         }
 
-        handle(expr::from_utf8(expr));
+        handle(expr);
     }
 
     return 0;